@@ -0,0 +1,178 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "asset_loader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+#include "resource_manager.h"
+#include "texture_cache.h"
+
+AssetLoader::AssetLoader(GLuint workers)
+    : stopping(GL_FALSE), pending(0), atlasPending(0) {
+    if (workers == 0)
+        workers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    for (GLuint i = 0; i < workers; ++i)
+        this->workers.push_back(std::thread(&AssetLoader::work, this));
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->stopping = GL_TRUE;
+    }
+    this->wake.notify_all();
+    for (std::thread &worker : this->workers)
+        worker.join();
+}
+
+std::shared_future<Texture2D> AssetLoader::LoadTexture(const std::string &file, ResourceID name) {
+    std::shared_ptr<std::promise<Texture2D>> promise = std::make_shared<std::promise<Texture2D>>();
+    ++this->pending;
+    // the name has to outlive the call, keep a copy next to its hash
+    GLuint hash = name.Hash;
+    std::string label(name.Name);
+    this->run([this, file, hash, label, promise]() {
+        std::shared_ptr<CachedTexture> image = std::make_shared<CachedTexture>();
+        LoadCachedTexture(file, 0, *image);
+        this->finish([this, file, hash, label, promise, image]() {
+            Texture2D texture;
+            // failed reads are reported by LoadCachedTexture
+            if (image->Levels > 0 && image->Channels != 3 && image->Channels != 4)
+                std::cout << "ERROR::TEXTURE: Unsupported number of channels ( " << image->Channels << " ) in file: " << file << std::endl;
+            else if (image->Levels > 0)
+                texture = this->upload(*image);
+            ResourceManager::addTexture(ResourceID(hash, label.c_str()), texture);
+            promise->set_value(texture);
+        });
+    });
+    return promise->get_future().share();
+}
+
+std::shared_future<Texture2D> AssetLoader::LoadAtlasTexture(const std::string &file, ResourceID name) {
+    std::shared_ptr<std::promise<Texture2D>> promise = std::make_shared<std::promise<Texture2D>>();
+    ++this->pending;
+    ++this->atlasPending;
+    GLuint hash = name.Hash;
+    std::string label(name.Name);
+    this->run([this, file, hash, label, promise]() {
+        // atlas pages are always RGBA, only the full size level is packed,
+        // the page builds its own mips once every image is in
+        std::shared_ptr<CachedTexture> image = std::make_shared<CachedTexture>();
+        LoadCachedTexture(file, 4, *image, GL_FALSE);
+        this->finish([this, hash, label, promise, image]() {
+            if (image->Levels > 0)
+                ResourceManager::Atlas.Add(label, image->Width, image->Height, image->Data[0]);
+            // regions are only known once every image is in
+            this->atlasWaiting.push_back([hash, label, promise]() {
+                promise->set_value(ResourceManager::GetTexture(ResourceManager::FindTexture(ResourceID(hash, label.c_str()))));
+            });
+            if (--this->atlasPending == 0) {
+                ResourceManager::BuildAtlas();
+                for (std::function<void()> &resolve : this->atlasWaiting)
+                    resolve();
+                this->atlasWaiting.clear();
+            }
+        });
+    });
+    return promise->get_future().share();
+}
+
+std::shared_future<Shader> AssetLoader::LoadShader(const std::string &vShaderFile, const std::string &fShaderFile, const std::string &gShaderFile, ResourceID name) {
+    std::shared_ptr<std::promise<Shader>> promise = std::make_shared<std::promise<Shader>>();
+    ++this->pending;
+    GLuint hash = name.Hash;
+    std::string label(name.Name);
+    this->run([this, vShaderFile, fShaderFile, gShaderFile, hash, label, promise]() {
+        std::string vShaderCode = ResourceManager::loadSourceCode(vShaderFile.c_str());
+        std::string fShaderCode = ResourceManager::loadSourceCode(fShaderFile.c_str());
+        std::string gShaderCode = gShaderFile.empty() ? "" : ResourceManager::loadSourceCode(gShaderFile.c_str());
+        this->finish([hash, label, promise, vShaderCode, fShaderCode, gShaderCode]() {
+            Shader shader = ResourceManager::compileShader(vShaderCode, fShaderCode, gShaderCode);
+            ResourceManager::addShader(ResourceID(hash, label.c_str()), shader);
+            promise->set_value(shader);
+        });
+    });
+    return promise->get_future().share();
+}
+
+std::shared_future<FontRaster> AssetLoader::LoadFont(const std::string &font, GLuint fontSize, TextRenderMode mode) {
+    std::shared_ptr<std::promise<FontRaster>> promise = std::make_shared<std::promise<FontRaster>>();
+    ++this->pending;
+    this->run([this, font, fontSize, mode, promise]() {
+        std::shared_ptr<FontRaster> raster = std::make_shared<FontRaster>(RasterizeFont(font, fontSize, mode));
+        // resolved with the rest so Pending covers it
+        this->finish([promise, raster]() { promise->set_value(*raster); });
+    });
+    return promise->get_future().share();
+}
+
+GLboolean AssetLoader::Update(GLdouble budget) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (this->pending > 0) {
+        std::function<void()> upload;
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+            if (this->finished.empty())
+                break;
+            upload = std::move(this->finished.front());
+            this->finished.pop_front();
+        }
+        upload();
+        --this->pending;
+        std::chrono::duration<GLdouble> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= budget)
+            break;
+    }
+    return this->pending == 0;
+}
+
+void AssetLoader::run(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->jobs.push_back(std::move(job));
+    }
+    this->wake.notify_one();
+}
+
+void AssetLoader::finish(std::function<void()> upload) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->finished.push_back(std::move(upload));
+}
+
+void AssetLoader::work() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> guard(this->lock);
+            this->wake.wait(guard, [this]() { return this->stopping || !this->jobs.empty(); });
+            if (this->jobs.empty())
+                return;
+            job = std::move(this->jobs.front());
+            this->jobs.pop_front();
+        }
+        job();
+    }
+}
+
+Texture2D AssetLoader::upload(const CachedTexture &image) {
+    Texture2D texture;
+    texture.Internal_Format = texture.Image_Format = image.Format;
+    // the levels are read where the cache left them, mapped or decoded on a worker
+    unsigned char* levels[TEXTURE_MAX_LEVELS];
+    for (GLuint level = 0; level < image.Levels; ++level)
+        levels[level] = const_cast<unsigned char*>(image.Data[level]);
+    // rows of RGB images are not always 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    texture.Generate(image.Width, image.Height, image.Levels, levels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return texture;
+}
@@ -0,0 +1,82 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "texture.h"
+#include "shader.h"
+#include "text_renderer.h"
+#include "texture_cache.h"
+#include "resource_id.h"
+
+// Loads assets in the background. File reads, image decoding and font
+// rasterization run on a pool of worker threads, everything that needs
+// the OpenGL context is queued for the thread owning it and happens in
+// Update, which keeps to a time budget so it can be called every frame.
+// Finished assets are registered with the ResourceManager under their
+// name and resolve the future returned by the request. The futures are
+// only resolved inside Update, so the GL thread must not wait on them.
+class AssetLoader {
+public:
+    // workers = 0 uses one thread per core but the calling one
+    AssetLoader(GLuint workers=0);
+    // Finishes the queued CPU work and stops the workers, uploads that never ran are dropped
+    ~AssetLoader();
+
+    // Load an image with its mip chain through the texture cache, the levels
+    // are uploaded on the GL thread straight from the cache entry
+    std::shared_future<Texture2D> LoadTexture(const std::string &file, ResourceID name);
+    // Decode an image as RGBA, the atlas is built once every queued atlas image is decoded
+    std::shared_future<Texture2D> LoadAtlasTexture(const std::string &file, ResourceID name);
+    // Read the shader sources, the program is compiled on the GL thread (gShaderFile may be empty)
+    std::shared_future<Shader> LoadShader(const std::string &vShaderFile, const std::string &fShaderFile, const std::string &gShaderFile, ResourceID name);
+    // Rasterize a font, see RasterizeFont. Needs no GL work, hand it to TextRenderer::Load
+    std::shared_future<FontRaster> LoadFont(const std::string &font, GLuint fontSize, TextRenderMode mode=TEXT_BITMAP);
+
+    // Run finished work on the GL thread until budget seconds have passed, at
+    // least one item per call. Returns true once every request is done.
+    GLboolean Update(GLdouble budget);
+    // Requests not completed by Update yet
+    GLuint Pending() const { return this->pending; }
+
+private:
+    std::vector<std::thread> workers;
+    // guards jobs, finished and stopping
+    std::mutex lock;
+    std::condition_variable wake;
+    // CPU work waiting for a worker
+    std::deque<std::function<void()>> jobs;
+    // GL work of jobs the workers finished, run by Update
+    std::deque<std::function<void()>> finished;
+    GLboolean stopping;
+    // touched by the GL thread only
+    GLuint pending;
+    GLuint atlasPending;
+    std::vector<std::function<void()>> atlasWaiting;
+
+    // Queue job for a worker, it hands its GL work to finish
+    void run(std::function<void()> job);
+    void finish(std::function<void()> upload);
+    void work();
+    // Create a texture with every level of image
+    Texture2D upload(const CachedTexture &image);
+};
+
+#endif
@@ -1,34 +0,0 @@
-/*******************************************************************
-** This code is part of Breakout.
-**
-** Breakout is free software: you can redistribute it and/or modify
-** it under the terms of the CC BY 4.0 license as published by
-** Creative Commons, either version 4 of the License, or (at your
-** option) any later version.
-******************************************************************/
-#ifndef BALL_OBJECT_H
-#define BALL_OBJECT_H
-
-#include <glad/glad.h>
-#include <glm/glm.hpp>
-
-#include "texture.h"
-#include "sprite_renderer.h"
-#include "game_object.h"
-
-// ball object a child of GameObject
-class BallObject : public GameObject {
-public:
-    GLfloat Radius;
-    GLboolean Stuck;
-    GLboolean Sticky, PassThrough;
-
-    // constructors
-    BallObject();
-    BallObject(glm::vec2 pos, GLfloat radius, glm::vec2 velocity, Texture2D sprite);
-
-    glm::vec2 Move(GLfloat dt, GLuint window_width);
-    void Reset(glm::vec2 position, glm::vec2 velocity);
-};
-
-#endif
@@ -10,9 +10,11 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <algorithm>
 
 #include "game.h"
 #include "resource_manager.h"
+#include "gl_state.h"
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 
@@ -20,6 +22,9 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 const GLuint SCREEN_WIDTH = 800;
 const GLuint SCREEN_HEIGHT = 600;
 
+static_assert(KEY_SPACE == GLFW_KEY_SPACE && KEY_A == GLFW_KEY_A && KEY_D == GLFW_KEY_D && KEY_S == GLFW_KEY_S
+    && KEY_W == GLFW_KEY_W && KEY_ENTER == GLFW_KEY_ENTER, "game key codes must match GLFW");
+
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
 
 int main(int argc, char* argv[]) {
@@ -51,11 +56,27 @@ int main(int argc, char* argv[]) {
     glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
     glEnable(GL_CULL_FACE);
     glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    Breakout.Init();
-    GLfloat deltaTime = 0.0f;
-    GLfloat lastFrame = 0.0f;
+    // assets stream in over the first frames, the window stays responsive meanwhile
+    Breakout.LoadAssets();
+    while (!glfwWindowShouldClose(window) && !Breakout.UpdateAssets(ASSET_FRAME_BUDGET)) {
+        glfwPollEvents();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glfwSwapBuffers(window);
+    }
+    // closed before the assets were in, the renderers were never created so skip the game entirely
+    GLboolean closed = glfwWindowShouldClose(window);
+    if (closed || !Breakout.Init()) {
+        Breakout.UnloadAssets();
+        ResourceManager::Clear();
+        glfwTerminate();
+        return closed ? 0 : -1;
+    }
+    const GLfloat tickTime = 1.0f / TICK_RATE;
+    GLfloat accumulator = 0.0f;
+    GLfloat lastFrame = glfwGetTime();
 
     Breakout.State = GAME_MENU;
 
@@ -63,22 +84,26 @@ int main(int argc, char* argv[]) {
     while (!glfwWindowShouldClose(window)) {
         // get timming
         GLfloat currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
+        accumulator += std::min(currentFrame - lastFrame, MAX_FRAME_TIME);
         lastFrame = currentFrame;
         glfwPollEvents();
 
-        Breakout.ProcessInput(deltaTime);
-        Breakout.Update(deltaTime);
+        // step the simulation at a fixed rate, independent of the frame rate
+        while (accumulator >= tickTime) {
+            Breakout.Tick(tickTime);
+            accumulator -= tickTime;
+        }
 
         //Render
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        Breakout.Render();
+        Breakout.Render(accumulator / tickTime);
 
         glfwSwapBuffers(window);
     }
 
     //cleanup assets
+    Breakout.UnloadAssets();
     ResourceManager::Clear();
 
     //close window
@@ -0,0 +1,210 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+// Runs the game simulation without a window, OpenGL or audio.
+//
+// usage: breakout_headless.out [-t ticks] [-s script] [-l level] [-r seed] [-c mode] [-p]
+//   -t  number of fixed ticks to simulate (default 12000, 100 s at TICK_RATE)
+//   -s  input script, one "<tick> <key> <press|release>" per line, '#' starts
+//       a comment. Keys are ENTER, SPACE, A, D, W and S
+//   -l  level selected before the script runs (default 0)
+//   -r  random seed used for power up spawns (default 1)
+//   -c  collision mode, discrete or continuous (default continuous)
+//   -p  autopilot, keep the paddle under the ball
+// Without a script the game is started and the ball launched on the first tick.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "game.h"
+
+// const parameters
+const GLuint SCREEN_WIDTH = 800;
+const GLuint SCREEN_HEIGHT = 600;
+
+const GLchar* DEFAULT_SCRIPT = "0 ENTER press\n1 ENTER release\n1 SPACE press\n";
+
+struct ScriptEvent {
+    GLuint Tick;
+    GLuint Key;
+    GLboolean Pressed;
+};
+
+GLboolean ParseScript(std::istream &stream, std::vector<ScriptEvent> &events);
+void Autopilot(Game &game);
+const GLchar* StateName(GameState state);
+
+int main(int argc, char* argv[]) {
+    GLuint ticks = 12000;
+    GLuint level = 0;
+    GLuint seed = 1;
+    CollisionMode collisions = COLLISION_CONTINUOUS;
+    GLboolean autopilot = GL_FALSE;
+    const GLchar* scriptFile = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            ticks = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            scriptFile = argv[++i];
+        else if (std::strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+            level = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            seed = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc && std::strcmp(argv[i + 1], "discrete") == 0 && ++i)
+            collisions = COLLISION_DISCRETE;
+        else if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc && std::strcmp(argv[i + 1], "continuous") == 0 && ++i)
+            collisions = COLLISION_CONTINUOUS;
+        else if (std::strcmp(argv[i], "-p") == 0)
+            autopilot = GL_TRUE;
+        else {
+            std::cout << "usage: " << argv[0] << " [-t ticks] [-s script] [-l level] [-r seed] [-c discrete|continuous] [-p]" << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<ScriptEvent> script;
+    GLboolean parsed;
+    if (scriptFile) {
+        std::ifstream stream(scriptFile);
+        if (!stream) {
+            std::cout << "ERROR::HEADLESS: Failed to open script: " << scriptFile << std::endl;
+            return -1;
+        }
+        parsed = ParseScript(stream, script);
+    } else {
+        std::istringstream stream(DEFAULT_SCRIPT);
+        parsed = ParseScript(stream, script);
+    }
+    if (!parsed)
+        return -1;
+
+    srand(seed);
+    Game breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (!breakout.Init())
+        return -1;
+    if (level >= breakout.Levels.size()) {
+        std::cout << "ERROR::HEADLESS: No level " << level << std::endl;
+        return -1;
+    }
+    breakout.Level = level;
+    breakout.Collisions = collisions;
+    breakout.State = GAME_MENU;
+
+    const GLfloat tickTime = 1.0f / TICK_RATE;
+    GLuint counts[EVENT_PADDLE_HIT + 1] = {0};
+    GLuint next = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (GLuint tick = 0; tick < ticks; ++tick) {
+        for (; next < script.size() && script[next].Tick <= tick; ++next) {
+            breakout.Keys[script[next].Key] = script[next].Pressed;
+            if (!script[next].Pressed)
+                breakout.KeysProcessed[script[next].Key] = GL_FALSE;
+        }
+        if (autopilot)
+            Autopilot(breakout);
+        breakout.Tick(tickTime);
+        // nothing presents the events, count them instead
+        for (GameEvent event : breakout.Events)
+            ++counts[event];
+        breakout.Events.clear();
+        breakout.Trails.clear();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    const BrickField &field = breakout.Levels[breakout.Level].Bricks;
+    GLuint bricks = 0, remaining = field.Remaining;
+    for (GLuint cell = 0; cell < field.Size(); ++cell) {
+        if (field.Types[cell] != BRICK_NONE && !field.IsSolid(cell))
+            ++bricks;
+    }
+    std::cout << "ticks:    " << ticks << " (" << ticks*tickTime << " s simulated) in " << elapsed.count() << " ms, "
+        << (elapsed.count() > 0.0 ? ticks / elapsed.count() * 1000.0 : 0.0) << " ticks/s" << std::endl;
+    std::cout << "state:    " << StateName(breakout.State) << ", level " << breakout.Level << ", lives " << breakout.Lives
+        << ", bricks " << remaining << "/" << bricks << " left" << std::endl;
+    if (breakout.Entities.IsAlive(breakout.Ball)) {
+        GLuint row;
+        const Archetype &ball = breakout.Entities.Locate(breakout.Ball, row);
+        std::cout << "ball:     position (" << ball.Position[row].x << ", " << ball.Position[row].y
+            << ") velocity (" << ball.Velocity[row].x << ", " << ball.Velocity[row].y << ")" << std::endl;
+    } else {
+        std::cout << "ball:     served ball lost, " << breakout.Entities.Count(COMPONENT_BALL) << " others in play" << std::endl;
+    }
+    std::cout << "events:   " << counts[EVENT_BRICK_DESTROYED] << " bricks destroyed, " << counts[EVENT_SOLID_HIT] << " solid hits, "
+        << counts[EVENT_POWERUP] << " power ups, " << counts[EVENT_PADDLE_HIT] << " paddle hits" << std::endl;
+    return 0;
+}
+
+GLboolean ParseScript(std::istream &stream, std::vector<ScriptEvent> &events) {
+    std::string line;
+    GLuint number = 0;
+    while (std::getline(stream, line)) {
+        ++number;
+        line = line.substr(0, line.find('#'));
+        std::istringstream sstream(line);
+        ScriptEvent event;
+        std::string key, action;
+        if (!(sstream >> event.Tick))
+            continue; // empty line
+        if (!(sstream >> key >> action) || (action != "press" && action != "release")) {
+            std::cout << "ERROR::HEADLESS: Malformed script line " << number << ": " << line << std::endl;
+            return GL_FALSE;
+        }
+        if (key == "ENTER")
+            event.Key = KEY_ENTER;
+        else if (key == "SPACE")
+            event.Key = KEY_SPACE;
+        else if (key == "A")
+            event.Key = KEY_A;
+        else if (key == "D")
+            event.Key = KEY_D;
+        else if (key == "W")
+            event.Key = KEY_W;
+        else if (key == "S")
+            event.Key = KEY_S;
+        else {
+            std::cout << "ERROR::HEADLESS: Unknown key on script line " << number << ": " << key << std::endl;
+            return GL_FALSE;
+        }
+        event.Pressed = action == "press";
+        events.push_back(event);
+    }
+    // keep events ordered by tick, the order within a tick is preserved
+    std::stable_sort(events.begin(), events.end(),
+        [](const ScriptEvent &a, const ScriptEvent &b) { return a.Tick < b.Tick; });
+    return GL_TRUE;
+}
+
+void Autopilot(Game &game) {
+    // follow the ball served last, the game always has it in play unless others are left
+    if (!game.Entities.IsAlive(game.Ball))
+        return;
+    GLuint row;
+    const Archetype &archetype = game.Entities.Locate(game.Ball, row);
+    GLfloat ball = archetype.Position[row].x + archetype.Radius[row];
+    GLfloat paddle = game.Player->Position.x + game.Player->Size.x / 2.0f;
+    // aim slightly off centre so the ball doesn't bounce straight up forever
+    GLfloat target = ball - game.Player->Size.x / 4.0f;
+    game.Keys[KEY_A] = paddle > target + 5.0f;
+    game.Keys[KEY_D] = paddle < target - 5.0f;
+}
+
+const GLchar* StateName(GameState state) {
+    if (state == GAME_ACTIVE)
+        return "active";
+    else if (state == GAME_MENU)
+        return "menu";
+    else if (state == GAME_WIN)
+        return "won";
+    return "lost";
+}
@@ -0,0 +1,60 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "brick_field.h"
+
+#include <algorithm>
+
+void BrickField::Init(const GLubyte* tiles, GLuint width, GLuint height, GLuint destructible, GLuint levelWidth, GLuint levelHeight) {
+    this->Clear();
+    if (width == 0 || height == 0)
+        return;
+    this->Width = width;
+    this->Height = height;
+    this->CellSize = glm::vec2(levelWidth/static_cast<GLfloat>(this->Width), levelHeight/static_cast<GLfloat>(this->Height));
+    this->Types.assign(tiles, tiles + width*height);
+    this->Destroyed.assign((this->Types.size() + 31) / 32, 0);
+    this->Destructible = this->Remaining = destructible;
+}
+
+void BrickField::Clear() {
+    this->Width = this->Height = 0;
+    this->CellSize = glm::vec2(0.0f);
+    this->Types.clear();
+    this->Destroyed.clear();
+    this->Destructible = this->Remaining = 0;
+}
+
+void BrickField::Reset() {
+    std::fill(this->Destroyed.begin(), this->Destroyed.end(), 0);
+    this->Remaining = this->Destructible;
+}
+
+void BrickField::Destroy(GLuint cell) {
+    if (this->IsSolid(cell) || !this->IsAlive(cell))
+        return;
+    this->Destroyed[cell >> 5] |= 1u << (cell & 31);
+    --this->Remaining;
+}
+
+void BrickField::Query(glm::vec2 min, glm::vec2 max, std::vector<GLuint> &cells) const {
+    cells.clear();
+    glm::vec2 extent = this->CellSize*glm::vec2(this->Width, this->Height);
+    if (this->Types.empty() || max.x < 0.0f || max.y < 0.0f || min.x >= extent.x || min.y >= extent.y)
+        return;
+    // range of cells covered by the area, clamped to the grid
+    glm::ivec2 first = glm::max(glm::ivec2(glm::floor(min / this->CellSize)), glm::ivec2(0));
+    glm::ivec2 last = glm::min(glm::ivec2(glm::floor(max / this->CellSize)), glm::ivec2(this->Width - 1, this->Height - 1));
+    for (GLint y = first.y; y <= last.y; ++y) {
+        for (GLint x = first.x; x <= last.x; ++x) {
+            GLuint cell = y*this->Width + x;
+            if (this->IsAlive(cell))
+                cells.push_back(cell);
+        }
+    }
+}
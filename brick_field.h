@@ -0,0 +1,69 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef BRICK_FIELD_H
+#define BRICK_FIELD_H
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Tile codes of the level files
+const GLubyte BRICK_NONE = 0;
+const GLubyte BRICK_SOLID = 1;
+// Colors of the tile codes, codes past the end use the last entry
+const GLuint BRICK_PALETTE_SIZE = 6;
+const glm::vec3 BRICK_PALETTE[BRICK_PALETTE_SIZE] = {
+    glm::vec3(1.0f),              // unused, empty tile
+    glm::vec3(0.8f, 0.8f, 0.7f),  // solid
+    glm::vec3(0.2f, 0.6f, 1.0f),
+    glm::vec3(0.0f, 0.7f, 0.0f),
+    glm::vec3(0.8f, 0.8f, 0.4f),
+    glm::vec3(1.0f, 0.5f, 0.0f)
+};
+
+
+// The bricks of a level as a grid of tile codes. A brick is addressed by
+// its cell index, its bounds follow from the grid and its color from the
+// palette, so the only per brick state is a type byte and a destroyed bit.
+struct BrickField {
+    // Grid size in cells and size of one cell in pixels
+    GLuint Width, Height;
+    glm::vec2 CellSize;
+    // Tile code per cell, row major
+    std::vector<GLubyte> Types;
+    // One bit per cell, set once the brick is destroyed
+    std::vector<GLuint> Destroyed;
+    // Destructible bricks in the level and those not destroyed yet
+    GLuint Destructible, Remaining;
+
+    BrickField() : Width(0), Height(0), CellSize(0.0f), Destructible(0), Remaining(0) { }
+
+    // Rebuild the field from width*height row major tile codes, scaled to fill
+    // the given area. destructible is the number of tiles above BRICK_SOLID.
+    void Init(const GLubyte* tiles, GLuint width, GLuint height, GLuint destructible, GLuint levelWidth, GLuint levelHeight);
+    void Clear();
+    // Bring every destroyed brick back, the tile codes never change during play
+    void Reset();
+
+    GLuint Size() const { return this->Types.size(); }
+    GLboolean IsSolid(GLuint cell) const { return this->Types[cell] == BRICK_SOLID; }
+    GLboolean IsDestroyed(GLuint cell) const { return (this->Destroyed[cell >> 5] >> (cell & 31)) & 1; }
+    // A brick that is present and can still be hit
+    GLboolean IsAlive(GLuint cell) const { return this->Types[cell] != BRICK_NONE && !this->IsDestroyed(cell); }
+    // Mark a destructible brick as destroyed, keeps Remaining up to date
+    void Destroy(GLuint cell);
+
+    glm::vec2 Position(GLuint cell) const { return glm::vec2(cell % this->Width, cell / this->Width)*this->CellSize; }
+    glm::vec3 Color(GLuint cell) const { return BRICK_PALETTE[glm::min<GLuint>(this->Types[cell], BRICK_PALETTE_SIZE - 1)]; }
+
+    // Collect the alive bricks in cells overlapping the area from min to max, in ascending order
+    void Query(glm::vec2 min, glm::vec2 max, std::vector<GLuint> &cells) const;
+};
+
+#endif
@@ -0,0 +1,122 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+// Microbenchmark comparing the original one brick at a time circle-AABB
+// test against the batch kernels in collision_kernel.cpp.
+//   usage: collision_bench.out [boxes] [circles] [rounds]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "collision_kernel.h"
+
+// Box layout and test as Game::DoCollisions used them before the batch kernels
+struct Box {
+    glm::vec2 Position, Size;
+};
+
+typedef std::tuple<GLboolean, Direction, glm::vec2> Collision;
+
+Direction VectorDirection(glm::vec2 target) {
+    glm::vec2 compass[] = {
+        glm::vec2(0.0f, 1.0f),  // up
+        glm::vec2(1.0f, 0.0f),  // right
+        glm::vec2(0.0f, -1.0f), // down
+        glm::vec2(-1.0f, 0.0f)  // left
+    };
+    GLfloat max = 0.0f;
+    GLuint best_match = -1;
+    for (GLuint i = 0; i < 4; i++) {
+        GLfloat dot_product = glm::dot(glm::normalize(target), compass[i]);
+        if (dot_product > max) {
+            max = dot_product;
+            best_match = i;
+        }
+    }
+    return (Direction)best_match;
+}
+
+Collision CheckCollision(glm::vec2 center, GLfloat radius, const Box &two) {
+    glm::vec2 aabb_half_extents(two.Size.x / 2, two.Size.y / 2);
+    glm::vec2 aabb_center(two.Position.x + aabb_half_extents.x, two.Position.y + aabb_half_extents.y);
+    glm::vec2 difference = center - aabb_center;
+    glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
+    glm::vec2 closest = aabb_center + clamped;
+    difference = closest - center;
+    if (glm::length(difference) < radius)
+        return std::make_tuple(GL_TRUE, VectorDirection(difference), difference);
+    else
+        return std::make_tuple(GL_FALSE, UP, glm::vec2(0, 0));
+}
+
+// Returns milliseconds per round
+template <typename Function>
+double Time(GLuint rounds, Function test) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (GLuint round = 0; round < rounds; ++round)
+        test();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count() / rounds;
+}
+
+int main(int argc, char* argv[]) {
+    GLuint count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    GLuint circles = argc > 2 ? std::atoi(argv[2]) : 16;
+    GLuint rounds = argc > 3 ? std::atoi(argv[3]) : 50;
+
+    // bricks on a regular grid like GameLevel lays them out, 100 per row
+    const glm::vec2 size(8.0f, 4.0f);
+    std::vector<Box> aos(count);
+    BoxStore soa;
+    soa.Resize(count);
+    for (GLuint i = 0; i < count; ++i) {
+        aos[i].Position = glm::vec2((i % 100)*size.x, (i / 100)*size.y);
+        aos[i].Size = size;
+        soa.Set(i, aos[i].Position, aos[i].Position + size);
+    }
+    std::vector<glm::vec2> centers(circles);
+    std::vector<GLfloat> radii(circles, 12.5f);
+    for (GLuint c = 0; c < circles; ++c)
+        centers[c] = glm::vec2(rand() % 800, rand() % (count / 100 * 4 + 1));
+
+    GLuint expected = 0;
+    std::cout << count << " boxes, " << circles << " circles, " << rounds << " rounds, " << CollisionKernelName(SelectCollisionKernel()) << " selected" << std::endl;
+    std::cout << "tuple   " << Time(rounds, [&]() {
+        expected = 0;
+        for (GLuint c = 0; c < circles; ++c) {
+            for (const Box &box : aos)
+                expected += std::get<0>(CheckCollision(centers[c], radii[c], box));
+        }
+    }) << " ms/round, " << expected << " hits" << std::endl;
+
+    // the scalar kernel is the reference the SIMD kernels have to match hit for hit
+    std::vector<CircleHit> reference;
+    CollideCirclesScalar(&centers[0], &radii[0], circles, soa, 0, count, reference);
+    CollisionKernel kernels[] = { CollideCirclesScalar, CollideCirclesSSE, CollideCirclesAVX };
+    std::vector<CircleHit> hits;
+    for (CollisionKernel kernel : kernels) {
+        if (kernel == CollideCirclesAVX && SelectCollisionKernel() != CollideCirclesAVX)
+            continue;
+        double ms = Time(rounds, [&]() {
+            hits.clear();
+            kernel(&centers[0], &radii[0], circles, soa, 0, count, hits);
+        });
+        GLboolean same = hits.size() == expected && hits.size() == reference.size();
+        for (GLuint i = 0; same && i < hits.size(); ++i)
+            same = hits[i].Circle == reference[i].Circle && hits[i].Box == reference[i].Box && hits[i].Face == reference[i].Face;
+        std::cout << CollisionKernelName(kernel) << "\t" << ms << " ms/round, " << hits.size() << " hits"
+            << (same ? "" : " MISMATCH") << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include <cmath>
+
+#include "collision_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COLLISION_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+void BoxStore::Resize(GLuint count) {
+    this->MinX.resize(count, 0.0f);
+    this->MinY.resize(count, 0.0f);
+    this->MaxX.resize(count, 0.0f);
+    this->MaxY.resize(count, 0.0f);
+}
+
+void BoxStore::Set(GLuint index, glm::vec2 min, glm::vec2 max) {
+    this->MinX[index] = min.x;
+    this->MinY[index] = min.y;
+    this->MaxX[index] = max.x;
+    this->MaxY[index] = max.y;
+}
+
+Direction HitFace(glm::vec2 difference) {
+    // the compass vector with the largest dot product is the one along the
+    // largest component. Ties resolve in compass order like the dot product
+    // search did: up before right before down before left
+    GLfloat x = std::abs(difference.x), y = std::abs(difference.y);
+    if (x > y || (x == y && difference.x > 0.0f && difference.y < 0.0f))
+        return difference.x > 0.0f ? RIGHT : LEFT;
+    return difference.y > 0.0f ? UP : DOWN;
+}
+
+GLboolean CircleOverlapsBox(glm::vec2 center, GLfloat radius, glm::vec2 min, glm::vec2 max, glm::vec2 &difference) {
+    difference = glm::clamp(center, min, max) - center;
+    // not <= since in that case a collision also occurs when the circle exactly touches the box
+    return glm::dot(difference, difference) < radius*radius;
+}
+
+// Appends the hit of circle against box, used by every kernel once a lane reported an overlap
+static void appendHit(GLuint circle, glm::vec2 center, const BoxStore &boxes, GLuint box, std::vector<CircleHit> &hits) {
+    CircleHit hit;
+    hit.Circle = circle;
+    hit.Box = box;
+    hit.Difference = glm::clamp(center, glm::vec2(boxes.MinX[box], boxes.MinY[box]), glm::vec2(boxes.MaxX[box], boxes.MaxY[box])) - center;
+    hit.Face = HitFace(hit.Difference);
+    hits.push_back(hit);
+}
+
+static void collideCircleScalar(GLuint circle, glm::vec2 center, GLfloat radius, const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits) {
+    GLfloat radius2 = radius*radius;
+    for (GLuint i = begin; i < end; ++i) {
+        GLfloat dx = glm::clamp(center.x, boxes.MinX[i], boxes.MaxX[i]) - center.x;
+        GLfloat dy = glm::clamp(center.y, boxes.MinY[i], boxes.MaxY[i]) - center.y;
+        if (dx*dx + dy*dy < radius2)
+            appendHit(circle, center, boxes, i, hits);
+    }
+}
+
+void CollideCirclesScalar(const glm::vec2 *centers, const GLfloat *radii, GLuint circles, const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits) {
+    for (GLuint c = 0; c < circles; ++c)
+        collideCircleScalar(c, centers[c], radii[c], boxes, begin, end, hits);
+}
+
+#ifdef COLLISION_KERNEL_X86
+
+__attribute__((target("sse2")))
+static GLuint collideCircleSSE(GLuint circle, glm::vec2 center, GLfloat radius, const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits) {
+    const __m128 cx = _mm_set1_ps(center.x);
+    const __m128 cy = _mm_set1_ps(center.y);
+    const __m128 radius2 = _mm_set1_ps(radius*radius);
+    const GLfloat* minX = boxes.MinX.data();
+    const GLfloat* minY = boxes.MinY.data();
+    const GLfloat* maxX = boxes.MaxX.data();
+    const GLfloat* maxY = boxes.MaxY.data();
+
+    GLuint i = begin;
+    for (; i + 4 <= end; i += 4) {
+        // distance from the centre to the closest point of each box
+        __m128 dx = _mm_sub_ps(_mm_min_ps(_mm_max_ps(cx, _mm_loadu_ps(minX + i)), _mm_loadu_ps(maxX + i)), cx);
+        __m128 dy = _mm_sub_ps(_mm_min_ps(_mm_max_ps(cy, _mm_loadu_ps(minY + i)), _mm_loadu_ps(maxY + i)), cy);
+        __m128 distance2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        GLint mask = _mm_movemask_ps(_mm_cmplt_ps(distance2, radius2));
+        // hits are rare, only those lanes are expanded
+        while (mask) {
+            appendHit(circle, center, boxes, i + __builtin_ctz(mask), hits);
+            mask &= mask - 1;
+        }
+    }
+    return i;
+}
+
+void CollideCirclesSSE(const glm::vec2 *centers, const GLfloat *radii, GLuint circles, const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits) {
+    for (GLuint c = 0; c < circles; ++c) {
+        GLuint i = collideCircleSSE(c, centers[c], radii[c], boxes, begin, end, hits);
+        collideCircleScalar(c, centers[c], radii[c], boxes, i, end, hits);
+    }
+}
+
+__attribute__((target("avx")))
+static GLuint collideCircleAVX(GLuint circle, glm::vec2 center, GLfloat radius, const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits) {
+    const __m256 cx = _mm256_set1_ps(center.x);
+    const __m256 cy = _mm256_set1_ps(center.y);
+    const __m256 radius2 = _mm256_set1_ps(radius*radius);
+    const GLfloat* minX = boxes.MinX.data();
+    const GLfloat* minY = boxes.MinY.data();
+    const GLfloat* maxX = boxes.MaxX.data();
+    const GLfloat* maxY = boxes.MaxY.data();
+
+    GLuint i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_min_ps(_mm256_max_ps(cx, _mm256_loadu_ps(minX + i)), _mm256_loadu_ps(maxX + i)), cx);
+        __m256 dy = _mm256_sub_ps(_mm256_min_ps(_mm256_max_ps(cy, _mm256_loadu_ps(minY + i)), _mm256_loadu_ps(maxY + i)), cy);
+        __m256 distance2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        GLint mask = _mm256_movemask_ps(_mm256_cmp_ps(distance2, radius2, _CMP_LT_OQ));
+        while (mask) {
+            appendHit(circle, center, boxes, i + __builtin_ctz(mask), hits);
+            mask &= mask - 1;
+        }
+    }
+    return i;
+}
+
+void CollideCirclesAVX(const glm::vec2 *centers, const GLfloat *radii, GLuint circles, const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits) {
+    for (GLuint c = 0; c < circles; ++c) {
+        GLuint i = collideCircleAVX(c, centers[c], radii[c], boxes, begin, end, hits);
+        i = collideCircleSSE(c, centers[c], radii[c], boxes, i, end, hits);
+        collideCircleScalar(c, centers[c], radii[c], boxes, i, end, hits);
+    }
+}
+
+CollisionKernel SelectCollisionKernel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx"))
+        return CollideCirclesAVX;
+    if (__builtin_cpu_supports("sse2"))
+        return CollideCirclesSSE;
+    return CollideCirclesScalar;
+}
+
+#else
+
+// no SIMD paths on this architecture, fall back to the scalar loop
+void CollideCirclesSSE(const glm::vec2 *centers, const GLfloat *radii, GLuint circles, const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits) {
+    CollideCirclesScalar(centers, radii, circles, boxes, begin, end, hits);
+}
+
+void CollideCirclesAVX(const glm::vec2 *centers, const GLfloat *radii, GLuint circles, const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits) {
+    CollideCirclesScalar(centers, radii, circles, boxes, begin, end, hits);
+}
+
+CollisionKernel SelectCollisionKernel() {
+    return CollideCirclesScalar;
+}
+
+#endif
+
+const char* CollisionKernelName(CollisionKernel kernel) {
+#ifdef COLLISION_KERNEL_X86
+    if (kernel == CollideCirclesAVX)
+        return "avx";
+    if (kernel == CollideCirclesSSE)
+        return "sse";
+#endif
+    return "scalar";
+}
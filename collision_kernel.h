@@ -0,0 +1,66 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef COLLISION_KERNEL_H
+#define COLLISION_KERNEL_H
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// collision directions
+enum Direction {
+    UP,
+    RIGHT,
+    DOWN,
+    LEFT
+};
+
+
+// Axis aligned boxes stored as structure of arrays, the batch kernels
+// test several boxes against a circle per instruction.
+struct BoxStore {
+    std::vector<GLfloat> MinX, MinY;
+    std::vector<GLfloat> MaxX, MaxY;
+
+    void Resize(GLuint count);
+    void Set(GLuint index, glm::vec2 min, glm::vec2 max);
+    GLuint Size() const { return this->MinX.size(); }
+};
+
+// A circle overlapping a box
+struct CircleHit {
+    GLuint Circle;
+    GLuint Box;
+    // Closest point of the box minus the circle centre, and the compass
+    // direction it points in
+    glm::vec2 Difference;
+    Direction Face;
+};
+
+
+// Compass direction of a vector from its largest component, no normalization needed
+Direction HitFace(glm::vec2 difference);
+// Tests one circle against one box by comparing squared distances
+GLboolean CircleOverlapsBox(glm::vec2 center, GLfloat radius, glm::vec2 min, glm::vec2 max, glm::vec2 &difference);
+
+// Tests every circle against boxes [begin, end) and appends the overlaps to
+// hits, ordered by circle and then by box
+typedef void (*CollisionKernel)(const glm::vec2 *centers, const GLfloat *radii, GLuint circles,
+    const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits);
+
+void CollideCirclesScalar(const glm::vec2 *centers, const GLfloat *radii, GLuint circles, const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits);
+void CollideCirclesSSE(const glm::vec2 *centers, const GLfloat *radii, GLuint circles, const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits);
+void CollideCirclesAVX(const glm::vec2 *centers, const GLfloat *radii, GLuint circles, const BoxStore &boxes, GLuint begin, GLuint end, std::vector<CircleHit> &hits);
+
+// Returns the widest kernel this CPU supports
+CollisionKernel SelectCollisionKernel();
+// Human readable name of a kernel, for logging and benchmarks
+const char* CollisionKernelName(CollisionKernel kernel);
+
+#endif
@@ -0,0 +1,314 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "entity_world.h"
+
+GLuint Archetype::Push(GLuint entity) {
+    GLuint row = this->Size();
+    this->Resize(row + 1);
+    this->Entities[row] = entity;
+    return row;
+}
+
+void Archetype::Move(GLuint from, GLuint to) {
+    this->Entities[to] = this->Entities[from];
+    if (this->Mask & COMPONENT_TRANSFORM) {
+        this->Position[to] = this->Position[from];
+        this->PrevPosition[to] = this->PrevPosition[from];
+        this->Extent[to] = this->Extent[from];
+    }
+    if (this->Mask & COMPONENT_VELOCITY)
+        this->Velocity[to] = this->Velocity[from];
+    if (this->Mask & COMPONENT_SPRITE) {
+        this->Sprite[to] = this->Sprite[from];
+        this->Color[to] = this->Color[from];
+    }
+    if (this->Mask & COMPONENT_COLLIDER)
+        this->Collider[to] = this->Collider[from];
+    if (this->Mask & COMPONENT_LIFETIME)
+        this->Lifetime[to] = this->Lifetime[from];
+    if (this->Mask & COMPONENT_POWERUP)
+        this->PowerUpType[to] = this->PowerUpType[from];
+    if (this->Mask & COMPONENT_BALL) {
+        this->Radius[to] = this->Radius[from];
+        this->Stuck[to] = this->Stuck[from];
+    }
+}
+
+void Archetype::CopyFrom(const Archetype &other, GLuint otherRow, GLuint row) {
+    ComponentMask shared = this->Mask & other.Mask;
+    if (shared & COMPONENT_TRANSFORM) {
+        this->Position[row] = other.Position[otherRow];
+        this->PrevPosition[row] = other.PrevPosition[otherRow];
+        this->Extent[row] = other.Extent[otherRow];
+    }
+    if (shared & COMPONENT_VELOCITY)
+        this->Velocity[row] = other.Velocity[otherRow];
+    if (shared & COMPONENT_SPRITE) {
+        this->Sprite[row] = other.Sprite[otherRow];
+        this->Color[row] = other.Color[otherRow];
+    }
+    if (shared & COMPONENT_COLLIDER)
+        this->Collider[row] = other.Collider[otherRow];
+    if (shared & COMPONENT_LIFETIME)
+        this->Lifetime[row] = other.Lifetime[otherRow];
+    if (shared & COMPONENT_POWERUP)
+        this->PowerUpType[row] = other.PowerUpType[otherRow];
+    if (shared & COMPONENT_BALL) {
+        this->Radius[row] = other.Radius[otherRow];
+        this->Stuck[row] = other.Stuck[otherRow];
+    }
+}
+
+void Archetype::Resize(GLuint count) {
+    this->Entities.resize(count, ENTITY_NONE);
+    if (this->Mask & COMPONENT_TRANSFORM) {
+        this->Position.resize(count, glm::vec2(0.0f));
+        this->PrevPosition.resize(count, glm::vec2(0.0f));
+        this->Extent.resize(count, glm::vec2(1.0f));
+    }
+    if (this->Mask & COMPONENT_VELOCITY)
+        this->Velocity.resize(count, glm::vec2(0.0f));
+    if (this->Mask & COMPONENT_SPRITE) {
+        this->Sprite.resize(count, 0);
+        this->Color.resize(count, glm::vec3(1.0f));
+    }
+    if (this->Mask & COMPONENT_COLLIDER)
+        this->Collider.resize(count, 0);
+    if (this->Mask & COMPONENT_LIFETIME)
+        this->Lifetime.resize(count, 0.0f);
+    if (this->Mask & COMPONENT_POWERUP)
+        this->PowerUpType.resize(count, 0);
+    if (this->Mask & COMPONENT_BALL) {
+        this->Radius.resize(count, 0.0f);
+        this->Stuck.resize(count, GL_FALSE);
+    }
+}
+
+Entity EntityWorld::Create(ComponentMask mask) {
+    GLuint slot;
+    if (!this->freeSlots.empty()) {
+        slot = this->freeSlots.back();
+        this->freeSlots.pop_back();
+    } else {
+        slot = this->generation.size();
+        this->archetypeOf.push_back(ENTITY_NONE);
+        this->rowOf.push_back(0);
+        this->generation.push_back(0);
+    }
+    GLuint archetype = this->archetype(mask);
+    this->archetypeOf[slot] = archetype;
+    this->rowOf[slot] = this->Archetypes[archetype].Push(slot);
+    Entity entity = {slot, this->generation[slot]};
+    return entity;
+}
+
+void EntityWorld::Destroy(Entity entity) {
+    if (!this->IsAlive(entity))
+        return;
+    Archetype &archetype = this->Archetypes[this->archetypeOf[entity.Index]];
+    archetype.Entities[this->rowOf[entity.Index]] = ENTITY_NONE;
+    archetype.Removed++;
+    this->archetypeOf[entity.Index] = ENTITY_NONE;
+    this->generation[entity.Index]++;
+    this->freeSlots.push_back(entity.Index);
+}
+
+GLboolean EntityWorld::IsAlive(Entity entity) const {
+    return entity.Index < this->generation.size() && this->generation[entity.Index] == entity.Generation
+        && this->archetypeOf[entity.Index] != ENTITY_NONE;
+}
+
+void EntityWorld::SetComponents(Entity entity, ComponentMask mask) {
+    if (!this->IsAlive(entity))
+        return;
+    GLuint from = this->archetypeOf[entity.Index];
+    if (this->Archetypes[from].Mask == mask)
+        return;
+    // look the target up first, adding an archetype may move the others
+    GLuint to = this->archetype(mask);
+    Archetype &source = this->Archetypes[from];
+    Archetype &target = this->Archetypes[to];
+    GLuint sourceRow = this->rowOf[entity.Index];
+    GLuint row = target.Push(entity.Index);
+    target.CopyFrom(source, sourceRow, row);
+    source.Entities[sourceRow] = ENTITY_NONE;
+    source.Removed++;
+    this->archetypeOf[entity.Index] = to;
+    this->rowOf[entity.Index] = row;
+}
+
+Archetype& EntityWorld::Locate(Entity entity, GLuint &row) {
+    row = this->rowOf[entity.Index];
+    return this->Archetypes[this->archetypeOf[entity.Index]];
+}
+
+Entity EntityWorld::At(const Archetype &archetype, GLuint row) const {
+    GLuint slot = archetype.Entities[row];
+    Entity entity = {slot, this->generation[slot]};
+    return entity;
+}
+
+GLuint EntityWorld::AddSprite(const Texture2D &sprite) {
+    for (GLuint i = 0; i < this->Sprites.size(); ++i) {
+        if (this->Sprites[i].ID == sprite.ID && this->Sprites[i].Region == sprite.Region)
+            return i;
+    }
+    this->Sprites.push_back(sprite);
+    return this->Sprites.size() - 1;
+}
+
+void EntityWorld::Flush() {
+    for (Archetype &archetype : this->Archetypes) {
+        if (archetype.Removed == 0)
+            continue;
+        // slide the rows that are alive down over the removed ones, in order
+        GLuint count = 0;
+        for (GLuint row = 0; row < archetype.Size(); ++row) {
+            if (!archetype.IsAlive(row))
+                continue;
+            if (row != count) {
+                archetype.Move(row, count);
+                this->rowOf[archetype.Entities[count]] = count;
+            }
+            ++count;
+        }
+        archetype.Resize(count);
+        archetype.Removed = 0;
+    }
+}
+
+void EntityWorld::Clear() {
+    for (Archetype &archetype : this->Archetypes) {
+        archetype.Resize(0);
+        archetype.Removed = 0;
+    }
+    this->freeSlots.clear();
+    for (GLuint slot = 0; slot < this->generation.size(); ++slot) {
+        if (this->archetypeOf[slot] != ENTITY_NONE)
+            this->generation[slot]++;
+        this->archetypeOf[slot] = ENTITY_NONE;
+        this->freeSlots.push_back(slot);
+    }
+}
+
+GLuint EntityWorld::Count(ComponentMask mask) const {
+    GLuint count = 0;
+    for (const Archetype &archetype : this->Archetypes) {
+        if (archetype.Has(mask))
+            count += archetype.Size() - archetype.Removed;
+    }
+    return count;
+}
+
+GLuint EntityWorld::archetype(ComponentMask mask) {
+    for (GLuint i = 0; i < this->Archetypes.size(); ++i) {
+        if (this->Archetypes[i].Mask == mask)
+            return i;
+    }
+    this->Archetypes.push_back(Archetype(mask));
+    return this->Archetypes.size() - 1;
+}
+
+void SnapshotPositions(EntityWorld &world) {
+    for (Archetype &archetype : world.Archetypes) {
+        if (archetype.Has(COMPONENT_TRANSFORM))
+            archetype.PrevPosition = archetype.Position;
+    }
+}
+
+void MoveEntities(EntityWorld &world, GLfloat dt) {
+    for (Archetype &archetype : world.Archetypes) {
+        if (!archetype.Has(COMPONENT_TRANSFORM | COMPONENT_VELOCITY) || archetype.Has(COMPONENT_BALL))
+            continue;
+        // removed rows move too, that is cheaper than testing for them
+        glm::vec2 *position = archetype.Position.data();
+        const glm::vec2 *velocity = archetype.Velocity.data();
+        for (GLuint row = 0; row < archetype.Size(); ++row)
+            position[row] += velocity[row] * dt;
+    }
+}
+
+void MoveBalls(EntityWorld &world, GLfloat dt, GLfloat width) {
+    for (Archetype &archetype : world.Archetypes) {
+        if (!archetype.Has(COMPONENT_TRANSFORM | COMPONENT_VELOCITY | COMPONENT_BALL))
+            continue;
+        for (GLuint row = 0; row < archetype.Size(); ++row) {
+            if (archetype.Stuck[row])
+                continue;
+            glm::vec2 &position = archetype.Position[row];
+            glm::vec2 &velocity = archetype.Velocity[row];
+            position += velocity*dt;
+            if (position.x <= 0.0f) {
+                velocity.x = -velocity.x;
+                position.x = 0.0f;
+            } else if (position.x + archetype.Extent[row].x >= width) {
+                velocity.x = -velocity.x;
+                position.x = width - archetype.Extent[row].x;
+            }
+            if (position.y <= 0.0f) {
+                velocity.y = -velocity.y;
+                position.y = 0.0f;
+            }
+        }
+    }
+}
+
+void AgeEntities(EntityWorld &world, GLfloat dt, std::vector<Entity> &expired) {
+    for (Archetype &archetype : world.Archetypes) {
+        if (!archetype.Has(COMPONENT_LIFETIME))
+            continue;
+        GLfloat *lifetime = archetype.Lifetime.data();
+        for (GLuint row = 0; row < archetype.Size(); ++row) {
+            lifetime[row] -= dt;
+            if (lifetime[row] <= 0.0f && archetype.IsAlive(row))
+                expired.push_back(world.At(archetype, row));
+        }
+    }
+}
+
+void OverlapEntities(EntityWorld &world, GLuint layer, glm::vec2 min, glm::vec2 max, std::vector<Entity> &hits) {
+    for (Archetype &archetype : world.Archetypes) {
+        if (!archetype.Has(COMPONENT_TRANSFORM | COMPONENT_COLLIDER))
+            continue;
+        for (GLuint row = 0; row < archetype.Size(); ++row) {
+            glm::vec2 position = archetype.Position[row];
+            glm::vec2 size = archetype.Extent[row];
+            if ((archetype.Collider[row] & layer) && archetype.IsAlive(row)
+                && max.x >= position.x && position.x + size.x >= min.x
+                && max.y >= position.y && position.y + size.y >= min.y)
+                hits.push_back(world.At(archetype, row));
+        }
+    }
+}
+
+void CullEntities(EntityWorld &world, GLfloat bottom) {
+    for (Archetype &archetype : world.Archetypes) {
+        if (!archetype.Has(COMPONENT_TRANSFORM | COMPONENT_VELOCITY) || archetype.Has(COMPONENT_BALL))
+            continue;
+        for (GLuint row = 0; row < archetype.Size(); ++row) {
+            if (archetype.Position[row].y >= bottom && archetype.IsAlive(row))
+                world.Destroy(world.At(archetype, row));
+        }
+    }
+}
+
+GLuint DropBalls(EntityWorld &world, GLfloat bottom) {
+    GLuint dropped = 0;
+    for (Archetype &archetype : world.Archetypes) {
+        if (!archetype.Has(COMPONENT_TRANSFORM | COMPONENT_BALL))
+            continue;
+        for (GLuint row = 0; row < archetype.Size(); ++row) {
+            if (archetype.Position[row].y >= bottom && archetype.IsAlive(row)) {
+                world.Destroy(world.At(archetype, row));
+                ++dropped;
+            }
+        }
+    }
+    return dropped;
+}
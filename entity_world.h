@@ -0,0 +1,140 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef ENTITY_WORLD_H
+#define ENTITY_WORLD_H
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "texture.h"
+
+// Components an entity can be made of, an archetype is a combination of them
+enum Component {
+    COMPONENT_TRANSFORM = 1 << 0,   // Position, PrevPosition and Extent (width, height)
+    COMPONENT_VELOCITY  = 1 << 1,   // Velocity in pixels per second
+    COMPONENT_SPRITE    = 1 << 2,   // Sprite index into EntityWorld::Sprites and Color
+    COMPONENT_COLLIDER  = 1 << 3,   // Collision layers the box of the transform belongs to
+    COMPONENT_LIFETIME  = 1 << 4,   // Seconds until the entity expires
+    COMPONENT_POWERUP   = 1 << 5,   // Index into the PowerUpRegistry
+    COMPONENT_BALL      = 1 << 6    // Radius and whether the ball rides on the paddle
+};
+typedef GLuint ComponentMask;
+
+// Collision layers of COMPONENT_COLLIDER
+const GLuint COLLIDE_PADDLE = 1 << 0;
+
+// Marks a free slot in the entity table and a removed row in an archetype
+const GLuint ENTITY_NONE = 0xFFFFFFFF;
+
+// Handle to an entity, stays valid while its row moves between and within
+// archetypes. The generation tells a reused slot from the entity that
+// was destroyed there before.
+struct Entity {
+    GLuint Index, Generation;
+};
+
+
+// All entities with exactly the same components. Every component is a
+// column of its own, row i of every column belongs to Entities[i], so a
+// system only touches the arrays it reads. Columns of components outside
+// Mask stay empty.
+struct Archetype {
+    ComponentMask Mask;
+    // Entity slot owning each row, ENTITY_NONE once destroyed
+    std::vector<GLuint> Entities;
+    // COMPONENT_TRANSFORM
+    std::vector<glm::vec2> Position, PrevPosition, Extent;
+    // COMPONENT_VELOCITY
+    std::vector<glm::vec2> Velocity;
+    // COMPONENT_SPRITE
+    std::vector<GLuint> Sprite;
+    std::vector<glm::vec3> Color;
+    // COMPONENT_COLLIDER
+    std::vector<GLuint> Collider;
+    // COMPONENT_LIFETIME
+    std::vector<GLfloat> Lifetime;
+    // COMPONENT_POWERUP
+    std::vector<GLuint> PowerUpType;
+    // COMPONENT_BALL
+    std::vector<GLfloat> Radius;
+    std::vector<GLboolean> Stuck;
+    // Rows destroyed since the last EntityWorld::Flush
+    GLuint Removed;
+
+    Archetype(ComponentMask mask) : Mask(mask), Removed(0) { }
+
+    GLuint Size() const { return this->Entities.size(); }
+    GLboolean Has(ComponentMask mask) const { return (this->Mask & mask) == mask; }
+    GLboolean IsAlive(GLuint row) const { return this->Entities[row] != ENTITY_NONE; }
+    // Append a row with default components for entity slot, returns the row
+    GLuint Push(GLuint entity);
+    // Overwrite row to with row from, in this archetype
+    void Move(GLuint from, GLuint to);
+    // Copy the components both archetypes have from row of other into row
+    void CopyFrom(const Archetype &other, GLuint otherRow, GLuint row);
+    void Resize(GLuint count);
+};
+
+
+// Entities stored by archetype. Creating and changing the components of
+// an entity take effect at once, destroyed rows are only skipped until
+// Flush packs the archetypes, which keeps their order so systems visit
+// entities in the order they were added.
+class EntityWorld {
+public:
+    std::vector<Archetype> Archetypes;
+    // Textures referenced by COMPONENT_SPRITE
+    std::vector<Texture2D> Sprites;
+
+    Entity Create(ComponentMask mask);
+    void Destroy(Entity entity);
+    GLboolean IsAlive(Entity entity) const;
+    // Move entity to the archetype of mask, keeping the components it had in both
+    void SetComponents(Entity entity, ComponentMask mask);
+    // Archetype and row currently holding entity
+    Archetype& Locate(Entity entity, GLuint &row);
+    // Entity of a row that is alive
+    Entity At(const Archetype &archetype, GLuint row) const;
+    // Index of sprite in Sprites, added if it isn't there yet
+    GLuint AddSprite(const Texture2D &sprite);
+    // Pack the archetypes after rows were destroyed
+    void Flush();
+    // Destroy every entity
+    void Clear();
+    // Entities alive with at least the components of mask
+    GLuint Count(ComponentMask mask=0) const;
+
+private:
+    // Per entity slot: archetype, row and generation
+    std::vector<GLuint> archetypeOf, rowOf, generation;
+    std::vector<GLuint> freeSlots;
+
+    GLuint archetype(ComponentMask mask);
+};
+
+
+// Systems, each runs over all archetypes with the components it needs
+
+// Remember positions at the start of a tick for interpolated rendering
+void SnapshotPositions(EntityWorld &world);
+// Advance entities with a velocity by dt, balls are moved by MoveBalls
+void MoveEntities(EntityWorld &world, GLfloat dt);
+// Advance the balls that aren't stuck by dt, bouncing off the side walls at 0 and width and off the top
+void MoveBalls(EntityWorld &world, GLfloat dt, GLfloat width);
+// Count lifetimes down by dt, collects the entities whose time ran out in expired
+void AgeEntities(EntityWorld &world, GLfloat dt, std::vector<Entity> &expired);
+// Collect the colliders on layer overlapping the box from min to max, edges touching counts
+void OverlapEntities(EntityWorld &world, GLuint layer, glm::vec2 min, glm::vec2 max, std::vector<Entity> &hits);
+// Destroy moving entities whose top edge reached bottom, balls are left to DropBalls
+void CullEntities(EntityWorld &world, GLfloat bottom);
+// Destroy the balls whose top edge reached bottom, returns how many were destroyed
+GLuint DropBalls(EntityWorld &world, GLfloat bottom);
+
+#endif
@@ -0,0 +1,44 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "frame_uniforms.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "gl_state.h"
+
+static_assert(sizeof(FrameData) == 96, "FrameData must match the std140 layout of the FrameData block");
+
+FrameUniforms::FrameUniforms() {
+    this->Data.Projection = glm::mat4(1.0f);
+    this->Data.Viewport = glm::vec2(0.0f);
+    this->Data.Time = 0.0f;
+    this->Data.Confuse = this->Data.Chaos = this->Data.Shake = 0;
+    this->Data.Padding[0] = this->Data.Padding[1] = 0;
+
+    glGenBuffers(1, &this->UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), &this->Data, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, this->UBO);
+}
+
+FrameUniforms::~FrameUniforms() {
+    GLState::DeleteBuffers(1, &this->UBO);
+}
+
+void FrameUniforms::SetScreen(GLuint width, GLuint height) {
+    this->Data.Projection = glm::ortho(0.0f, static_cast<GLfloat>(width), static_cast<GLfloat>(height), 0.0f, -1.0f, 1.0f);
+    this->Data.Viewport = glm::vec2(width, height);
+}
+
+void FrameUniforms::Upload() {
+    glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &this->Data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,50 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Name and binding point of the uniform block shared by all programs
+const GLchar* const FRAME_UNIFORM_BLOCK = "FrameData";
+const GLuint FRAME_UNIFORM_BINDING = 0;
+
+// CPU copy of the FrameData block, laid out to match std140
+struct FrameData {
+    glm::mat4 Projection;   // offset 0
+    glm::vec2 Viewport;     // offset 64
+    GLfloat Time;           // offset 72
+    GLint Confuse;          // offset 76, GLSL bool
+    GLint Chaos;            // offset 80
+    GLint Shake;            // offset 84
+    GLint Padding[2];       // block size is rounded up to 96
+};
+
+// Owns the uniform buffer backing the FrameData block. Data is edited on
+// the CPU and sent to the GPU with a single buffer write per Upload.
+class FrameUniforms {
+public:
+    // State
+    FrameData Data;
+
+    // Constructor destructor
+    FrameUniforms();
+    ~FrameUniforms();
+
+    // Set projection and viewport for a screen of the given size
+    void SetScreen(GLuint width, GLuint height);
+    // Send Data to the GPU
+    void Upload();
+
+private:
+    GLuint UBO;
+};
+
+#endif
@@ -7,146 +7,120 @@
 ** option) any later version.
 ******************************************************************/
 #include <algorithm>
-#include <sstream>
-#include <iostream>
-
-#include <irrklang/irrKlang.h>
+#include <cmath>
 
 #include "game.h"
-#include "resource_manager.h"
-#include "text_renderer.h"
-#include "sprite_renderer.h"
-#include "post_processor.h"
-#include "particle_generator.h"
 #include "game_object.h"
-#include "ball_object.h"
-
-GameObject* Player;
-BallObject* Ball;
-SpriteRenderer* Renderer;
-ParticleGenerator* Particles;
-PostProcessor* Effects;
-TextRenderer* Text;
-irrklang::ISoundEngine* SoundEngine = irrklang::createIrrKlangDevice();
-GLfloat ShakeTime = 0.0f;
+#include "resource_names.h"
 
 GLboolean ShouldSpawn(GLuint chance);
-void ActivatePowerUp(PowerUp &powerUp);
-GLboolean IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type);
-GLboolean CheckCollision(GameObject &one, GameObject &two);
-Collision CheckCollision(BallObject &one, GameObject &two);
-Direction VectorDirection(glm::vec2 target);
+// AABB - Circle collision of a ball at position (top left corner) with the box from min to max
+Collision CheckCollision(glm::vec2 position, GLfloat radius, glm::vec2 min, glm::vec2 max);
+GLboolean SweepCircle(glm::vec2 center, GLfloat radius, glm::vec2 motion, glm::vec2 boxMin, glm::vec2 boxMax, GLfloat &time, glm::vec2 &normal);
+// Built-in power up effects, registered by name in Game::Init
+void ActivateSpeed(Game &game);
+void ActivateSticky(Game &game);
+void DeactivateSticky(Game &game);
+void ActivatePassThrough(Game &game);
+void DeactivatePassThrough(Game &game);
+void ActivatePadSizeIncrease(Game &game);
+void ActivateConfuse(Game &game);
+void DeactivateConfuse(Game &game);
+void ActivateChaos(Game &game);
+void DeactivateChaos(Game &game);
+void ColorBalls(Game &game, glm::vec3 color);
 
 Game::Game(GLuint width, GLuint height)
-    : State(GAME_ACTIVE), Keys(), Width(width), Height(height), Level(0), Lives(3) { }
+    : State(GAME_ACTIVE), Keys(), KeysProcessed(), Width(width), Height(height), Level(0), Lives(3), Collisions(COLLISION_CONTINUOUS), Player(nullptr), Ball(),
+      Sticky(GL_FALSE), PassThrough(GL_FALSE), Confuse(GL_FALSE), Chaos(GL_FALSE), Shake(GL_FALSE), ShakeTime(0.0f), Time(0.0f), ballSprite(0) { }
 
 Game::~Game() {
-    delete Renderer;
-    delete Ball;
-    delete Player;
-    delete Particles;
-    delete Effects;
-    delete Text;
-    SoundEngine->drop();
-}
-
-void Game::Init() {
-    // Load shaders
-    ResourceManager::LoadShader("shaders/sprite.vert", "shaders/sprite.frag", nullptr, "sprite");
-    ResourceManager::LoadShader("shaders/particle.vert", "shaders/particle.frag", nullptr, "particle");
-    ResourceManager::LoadShader("shaders/post_processing.vert", "shaders/post_processing.frag", nullptr, "postprocessing");
-
-    // Load Textures
-    ResourceManager::LoadTexture("textures/background.jpg", "background");
-    ResourceManager::LoadTexture("textures/awesomeface.png", "face");
-    ResourceManager::LoadTexture("textures/paddle.png", "paddle");
-    ResourceManager::LoadTexture("textures/block.png", "block");
-    ResourceManager::LoadTexture("textures/block_solid.png", "block_solid");
-    ResourceManager::LoadTexture("textures/particle.png", "particle");
-    ResourceManager::LoadTexture("textures/powerup_speed.png", "powerup_speed");
-    ResourceManager::LoadTexture("textures/powerup_sticky.png", "powerup_sticky");
-    ResourceManager::LoadTexture("textures/powerup_increase.png", "powerup_increase");
-    ResourceManager::LoadTexture("textures/powerup_confuse.png", "powerup_confuse");
-    ResourceManager::LoadTexture("textures/powerup_chaos.png", "powerup_chaos");
-    ResourceManager::LoadTexture("textures/powerup_passthrough.png", "powerup_passthrough");
-
-    // pass data to GPU glUniform
-    glm::mat4 projection = glm::ortho(0.0f, static_cast<GLfloat>(this->Width), static_cast<GLfloat>(this->Height), 0.0f, -1.0f, 1.0f);
-    ResourceManager::GetShader("sprite").Use().SetInteger("image", 0);
-    ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
-    ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
-    ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
+    delete this->Player;
+}
 
+GLboolean Game::Init() {
     // initalize Levels
-    GameLevel one, two, three, four;
-    one.Load("levels/one.lvl", this->Width, this->Height*0.5f);
-    two.Load("levels/two.lvl", this->Width, this->Height*0.5f);
-    three.Load("levels/three.lvl", this->Width, this->Height*0.5f);
-    four.Load("levels/four.lvl", this->Width, this->Height*0.5f);
-
-    this->Levels.push_back(one);
-    this->Levels.push_back(two);
-    this->Levels.push_back(three);
-    this->Levels.push_back(four);
+    if (!LoadLevels("data/levels.txt", this->Width, this->Height*0.5f, this->Levels))
+        return GL_FALSE;
 
     // set current level
     this->Level = 0;
 
+    // initialize power ups, the effects have to be known before the types are loaded
+    this->PowerUpTypes.RegisterEffect("speed", ActivateSpeed);
+    this->PowerUpTypes.RegisterEffect("sticky", ActivateSticky, DeactivateSticky);
+    this->PowerUpTypes.RegisterEffect("pass-through", ActivatePassThrough, DeactivatePassThrough);
+    this->PowerUpTypes.RegisterEffect("pad-size-increase", ActivatePadSizeIncrease);
+    this->PowerUpTypes.RegisterEffect("confuse", ActivateConfuse, DeactivateConfuse);
+    this->PowerUpTypes.RegisterEffect("chaos", ActivateChaos, DeactivateChaos);
+    if (!this->PowerUpTypes.Load("data/powerups.txt"))
+        return GL_FALSE;
+
     // initalize player
     glm::vec2 playerPos = glm::vec2((this->Width - PLAYER_SIZE.x)/2.0f, this->Height - PLAYER_SIZE.y);
     glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x/2.0f - BALL_RADIUS, -BALL_RADIUS*2.0f);
-    Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
-    Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
-
-    Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 500);
-    Renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"));
-    Effects = new PostProcessor(ResourceManager::GetShader("postprocessing"), this->Width, this->Height);
-    Text = new TextRenderer(this->Width, this->Height);
-    Text->Load("fonts/OCRAEXT.TTF", 24);
+    this->Player = new GameObject(playerPos, PLAYER_SIZE, GetSprite(TEXTURE_PADDLE));
+    this->ballSprite = this->Entities.AddSprite(GetSprite(TEXTURE_FACE));
+    this->Ball = this->SpawnBall(ballPos, INITIAL_BALL_VELOCITY, GL_TRUE);
+    return GL_TRUE;
+}
 
-    // audio
-    if (!MUTE_AUDIO)
-        SoundEngine->play2D("audio/breakout.mp3", GL_TRUE);
+void Game::Tick(GLfloat dt) {
+    this->Time += dt;
+    // remember where everything was so Render can blend towards the new state
+    this->Player->PrevPosition = this->Player->Position;
+    SnapshotPositions(this->Entities);
+    this->ProcessInput(dt);
+    this->Update(dt);
+    // every tick leaves a trail, no matter how many of them a frame runs
+    for (const Archetype &archetype : this->Entities.Archetypes) {
+        if (!archetype.Has(COMPONENT_BALL))
+            continue;
+        for (GLuint row = 0; row < archetype.Size(); ++row) {
+            if (archetype.IsAlive(row))
+                this->Trails.push_back({this->Time, archetype.Position[row], archetype.Velocity[row], archetype.Radius[row]});
+        }
+    }
 }
 
 void Game::ProcessInput(GLfloat dt) {
     if (this->State == GAME_MENU) {
-        if (this->Keys[GLFW_KEY_ENTER] && !this->KeysProcessed[GLFW_KEY_ENTER])
+        if (this->Keys[KEY_ENTER] && !this->KeysProcessed[KEY_ENTER])
         {
             this->State = GAME_ACTIVE;
-            this->KeysProcessed[GLFW_KEY_ENTER] = GL_TRUE;
+            this->KeysProcessed[KEY_ENTER] = GL_TRUE;
         }
-        if (this->Keys[GLFW_KEY_W] && !this->KeysProcessed[GLFW_KEY_W])
+        if (this->Keys[KEY_W] && !this->KeysProcessed[KEY_W])
         {
-            this->Level = (this->Level + 1) % 4;
-            this->KeysProcessed[GLFW_KEY_W] = GL_TRUE;
+            this->Level = (this->Level + 1) % this->Levels.size();
+            this->KeysProcessed[KEY_W] = GL_TRUE;
         }
-        if (this->Keys[GLFW_KEY_S] && !this->KeysProcessed[GLFW_KEY_S])
+        if (this->Keys[KEY_S] && !this->KeysProcessed[KEY_S])
         {
             if (this->Level > 0)
                 --this->Level;
             else
-                this->Level = 3;
-            this->KeysProcessed[GLFW_KEY_S] = GL_TRUE;
+                this->Level = this->Levels.size() - 1;
+            this->KeysProcessed[KEY_S] = GL_TRUE;
         }
     }
 
     if (this->State == GAME_WIN)
     {
-        if (this->Keys[GLFW_KEY_ENTER])
+        if (this->Keys[KEY_ENTER])
         {
-            this->KeysProcessed[GLFW_KEY_ENTER] = GL_TRUE;
-            Effects->Confuse = GL_FALSE;
+            this->KeysProcessed[KEY_ENTER] = GL_TRUE;
+            this->Confuse = GL_FALSE;
             this->State = GAME_MENU;
         }
     }
 
     if (this->State == GAME_LOSS)
     {
-        if (this->Keys[GLFW_KEY_ENTER])
+        if (this->Keys[KEY_ENTER])
         {
-            this->KeysProcessed[GLFW_KEY_ENTER] = GL_TRUE;
-            Effects->Chaos = GL_FALSE;
+            this->KeysProcessed[KEY_ENTER] = GL_TRUE;
+            this->Chaos = GL_FALSE;
             this->State = GAME_MENU;
         }
     }
@@ -155,265 +129,350 @@ void Game::ProcessInput(GLfloat dt) {
         GLfloat velocity = PLAYER_VELOCITY*dt;
 
         // handel key events
-        if (this->Keys[GLFW_KEY_A]) {
-            if (Player->Position.x >= 0)
-                Player->Position.x -= velocity;
-                if (Ball->Stuck)
-                    Ball->Position.x -= velocity;
+        if (this->Keys[KEY_A]) {
+            if (this->Player->Position.x >= 0) {
+                this->Player->Position.x -= velocity;
+                this->carryBalls(-velocity);
+            }
         }
 
-        if (this->Keys[GLFW_KEY_D]) {
-            if (Player->Position.x <= this->Width - Player->Size.x)
-                Player->Position.x += velocity;
-                if (Ball->Stuck)
-                    Ball->Position.x += velocity;
+        if (this->Keys[KEY_D]) {
+            if (this->Player->Position.x <= this->Width - this->Player->Size.x) {
+                this->Player->Position.x += velocity;
+                this->carryBalls(velocity);
+            }
         }
 
-        if (this->Keys[GLFW_KEY_SPACE]) {
-            Ball->Stuck = GL_FALSE;
+        if (this->Keys[KEY_SPACE]) {
+            for (Archetype &archetype : this->Entities.Archetypes) {
+                if (archetype.Has(COMPONENT_BALL))
+                    std::fill(archetype.Stuck.begin(), archetype.Stuck.end(), GL_FALSE);
+            }
         }
     }
 }
 
 void Game::Update(GLfloat dt) {
-    Ball->Move(dt, this->Width);
-    this->DoCollisions();
-    Particles->Update(dt, *Ball, 2, glm::vec2(Ball->Radius/2));
+    if (this->Collisions == COLLISION_CONTINUOUS) {
+        this->SweepBalls(dt);
+        this->collectPowerUps();
+    } else {
+        MoveBalls(this->Entities, dt, this->Width);
+        this->DoCollisions();
+    }
     this->UpdatePowerUps(dt);
 
-    if (ShakeTime > 0.0f) {
-        ShakeTime -= dt;
-        if (ShakeTime <= 0.0f)
-            Effects->Shake = false;
+    if (this->ShakeTime > 0.0f) {
+        this->ShakeTime -= dt;
+        if (this->ShakeTime <= 0.0f)
+            this->Shake = GL_FALSE;
     }
 
-    // ball loss condition
-    if (Ball->Position.y >= this->Height) {
+    // ball loss condition, a life is only lost with the last ball in play
+    if (DropBalls(this->Entities, this->Height) > 0 && this->Entities.Count(COMPONENT_BALL) == 0) {
         --this->Lives;
         this->ResetPlayer();
         if (this->Lives == 0) {
             this->ResetLevel();
             this->State = GAME_LOSS;
-            Effects->Confuse = GL_TRUE;
+            this->Confuse = GL_TRUE;
         }
     }
 
     if (this->State == GAME_ACTIVE && this->Levels[this->Level].IsCompleted()) {
         this->ResetLevel();
         this->ResetPlayer();
-        Effects->Chaos = GL_TRUE;
+        this->Chaos = GL_TRUE;
         this->State = GAME_WIN;
     }
 }
 
-void Game::Render() {
-    // configure OpenGL to render off screen
-    Effects->BeginRender();
-        // Background
-        Renderer->DrawSprite(ResourceManager::GetTexture("background"), glm::vec2(0, 0), glm::vec2(this->Width, this->Height), 0.0f);
-
-        // Objects
-        Particles->Draw();
-        Ball->Draw(*Renderer);
-        this->Levels[this->Level].Draw(*Renderer);
-        for (PowerUp &powerUp : this->PowerUps) {
-            if (!powerUp.Destroyed)
-                powerUp.Draw(*Renderer);
+void Game::DoCollisions() {
+    GameLevel &level = this->Levels[this->Level];
+    this->collectBalls();
+    for (Entity ball : this->balls) {
+        // work on a copy, hitting a brick can add entities and move the columns
+        GLuint row;
+        Archetype &archetype = this->Entities.Locate(ball, row);
+        glm::vec2 position = archetype.Position[row], velocity = archetype.Velocity[row];
+        GLfloat radius = archetype.Radius[row];
+        // only test bricks in cells the ball swept through this tick, with a
+        // radius of margin since resolving a hit pushes the ball out of a brick
+        glm::vec2 margin(radius);
+        glm::vec2 from = glm::min(archetype.PrevPosition[row], position) - margin;
+        glm::vec2 to = glm::max(archetype.PrevPosition[row], position) + archetype.Extent[row] + margin;
+        level.Bricks.Query(from, to, this->candidates);
+        for (GLuint cell : this->candidates) {
+            if (level.Bricks.IsAlive(cell)) {
+                glm::vec2 brick = level.Bricks.Position(cell);
+                Collision collision = CheckCollision(position, radius, brick, brick + level.Bricks.CellSize);
+                if (std::get<0>(collision)) { // If collision is true
+                    this->hitBrick(cell);
+                    // Collision resolution
+                    Direction dir = std::get<1>(collision);
+                    glm::vec2 diff_vector = std::get<2>(collision);
+                    if (dir == LEFT || dir == RIGHT) { // Horizontal collision
+                        velocity.x = -velocity.x; // Reverse horizontal velocity
+                        // Relocate
+                        GLfloat penetration = radius - std::abs(diff_vector.x);
+                        if (dir == LEFT)
+                            position.x += penetration; // Move ball to right
+                        else
+                            position.x -= penetration; // Move ball to left;
+                    } else {
+                        velocity.y = -velocity.y; // Reverse vertical velocity
+                        // Relocate
+                        GLfloat penetration = radius - std::abs(diff_vector.y);
+                        if (dir == UP)
+                            position.y -= penetration; // Move ball back up
+                        else
+                            position.y += penetration; // Move ball back down
+                    }
+                }
+            }
         }
-        Player->Draw(*Renderer);
-    // save render to texture and return OpenGL configuration to standard render
-    Effects->EndRender();
-    // render prerenderd scene to screen using postprocessing shaders
-    Effects->Render(glfwGetTime());
-    // dont include the text in the postprocessing
-    if (this->State == GAME_ACTIVE) {
-        std::stringstream stream_lives; stream_lives << this->Lives;
-        Text->RenderText("Lives:" + stream_lives.str(), 5.0f, 5.0f, 1.0f);
+        Archetype &moved = this->Entities.Locate(ball, row);
+        moved.Position[row] = position;
+        moved.Velocity[row] = velocity;
     }
 
-    if (this->State == GAME_MENU) {
-        Text->RenderText("Press ENTER to start", 250.0f, this->Height / 2, 1.0f);
-        Text->RenderText("Press W or S to select level", 245.0f, this->Height / 2 + 20.0f, 0.75f);
-    }
+    // Also check collisions on PowerUps and if so, activate them
+    this->collectPowerUps();
 
-    if (this->State == GAME_LOSS) {
-        Text->RenderText("You LOST :(", 320.0f, this->Height / 2 - 20.0f, 1.0f, glm::vec3(1.0f, 0.0f, 1.0f));
-        Text->RenderText("Press ENTER to retry or ESC to quit", 130.0f, this->Height / 2, 1.0f, glm::vec3(0.0f, 0.0f, 1.0f));
+    // Also check collisions for player pad (unless stuck)
+    for (Entity ball : this->balls) {
+        GLuint row;
+        Archetype &archetype = this->Entities.Locate(ball, row);
+        Collision result = CheckCollision(archetype.Position[row], archetype.Radius[row], this->Player->Position, this->Player->Position + this->Player->Size);
+        if (!archetype.Stuck[row] && std::get<0>(result))
+            this->bouncePaddle(archetype.Position[row], archetype.Radius[row], archetype.Velocity[row], archetype.Stuck[row]);
     }
+}
 
-    if (this->State == GAME_WIN) {
-        Text->RenderText("You WON!!!", 320.0f, this->Height / 2 - 20.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
-        Text->RenderText("Press ENTER to retry or ESC to quit", 130.0f, this->Height / 2, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
-    }
+void Game::SweepBalls(GLfloat dt) {
+    this->collectBalls();
+    for (Entity ball : this->balls)
+        this->sweepBall(ball, dt);
 }
 
-void Game::DoCollisions() {
-    for (GameObject &box : this->Levels[this->Level].Bricks) {
-        if (!box.Destroyed) {
-            Collision collision = CheckCollision(*Ball, box);
-            if (std::get<0>(collision)) { // If collision is true
-                // Destroy block if not solid
-                if (!box.IsSolid) {
-                    box.Destroyed = GL_TRUE;
-                    this->SpawnPowerUps(box);
-                    if (!MUTE_AUDIO)
-                        SoundEngine->play2D("audio/bleep.mp3", GL_FALSE);
-                } else {
-                    ShakeTime = 0.05f;
-                    Effects->Shake = true;
-                    if (!MUTE_AUDIO)
-                        SoundEngine->play2D("audio/solid.wav", GL_FALSE);
-                }
-                // Collision resolution
-                Direction dir = std::get<1>(collision);
-                glm::vec2 diff_vector = std::get<2>(collision);
-                if (dir == LEFT || dir == RIGHT) { // Horizontal collision
-                    Ball->Velocity.x = -Ball->Velocity.x; // Reverse horizontal velocity
-                    // Relocate
-                    GLfloat penetration = Ball->Radius - std::abs(diff_vector.x);
-                    if (dir == LEFT)
-                        Ball->Position.x += penetration; // Move ball to right
-                    else
-                        Ball->Position.x -= penetration; // Move ball to left;
-                } else {
-                    Ball->Velocity.y = -Ball->Velocity.y; // Reverse vertical velocity
-                    // Relocate
-                    GLfloat penetration = Ball->Radius - std::abs(diff_vector.y);
-                    if (dir == UP)
-                        Ball->Position.y -= penetration; // Move ball back up
-                    else
-                        Ball->Position.y += penetration; // Move ball back down
-                }
-            }
+void Game::sweepBall(Entity ball, GLfloat dt) {
+    GameLevel &level = this->Levels[this->Level];
+    // work on a copy, hitting a brick can add entities and move the columns
+    GLuint row;
+    Archetype &archetype = this->Entities.Locate(ball, row);
+    glm::vec2 position = archetype.Position[row], velocity = archetype.Velocity[row];
+    GLboolean stuck = archetype.Stuck[row];
+    GLfloat radius = archetype.Radius[row];
+    GLfloat remaining = dt;
+    for (GLuint i = 0; i < MAX_SWEEP_ITERATIONS && remaining > 0.0f && !stuck; ++i) {
+        glm::vec2 center = position + radius;
+        glm::vec2 motion = velocity*remaining;
+
+        // earliest impact along the motion, as a fraction of it
+        GLfloat first = 1.0f;
+        glm::vec2 normal(0.0f);
+        GLint hit = -1;
+        GLfloat time;
+        glm::vec2 hitNormal;
+
+        // walls, the bottom is open
+        if (motion.x < 0.0f && center.x - radius + motion.x <= 0.0f) {
+            time = glm::max((center.x - radius) / -motion.x, 0.0f);
+            if (time < first) { first = time; normal = glm::vec2(1.0f, 0.0f); }
+        } else if (motion.x > 0.0f && center.x + radius + motion.x >= this->Width) {
+            time = glm::max((this->Width - center.x - radius) / motion.x, 0.0f);
+            if (time < first) { first = time; normal = glm::vec2(-1.0f, 0.0f); }
+        }
+        if (motion.y < 0.0f && center.y - radius + motion.y <= 0.0f) {
+            time = glm::max((center.y - radius) / -motion.y, 0.0f);
+            if (time < first) { first = time; normal = glm::vec2(0.0f, 1.0f); }
         }
-    }
 
-    // Also check collisions on PowerUps and if so, activate them
-    for (PowerUp &powerUp : this->PowerUps) {
-        if (!powerUp.Destroyed) {
-            // First check if powerup passed bottom edge, if so: keep as inactive and destroy
-            if (powerUp.Position.y >= this->Height)
-                powerUp.Destroyed = GL_TRUE;
-
-            // Collided with player, now activate powerup
-            if (CheckCollision(*Player, powerUp)) {
-                ActivatePowerUp(powerUp);
-                powerUp.Destroyed = GL_TRUE;
-                powerUp.Activated = GL_TRUE;
-                if (!MUTE_AUDIO)
-                    SoundEngine->play2D("audio/powerup.wav", GL_FALSE);
+        // bricks in the cells covered by the rest of the motion
+        glm::vec2 from = glm::min(center, center + motion) - radius;
+        glm::vec2 to = glm::max(center, center + motion) + radius;
+        level.Bricks.Query(from, to, this->candidates);
+        for (GLuint cell : this->candidates) {
+            glm::vec2 brick = level.Bricks.Position(cell);
+            if (SweepCircle(center, radius, motion, brick, brick + level.Bricks.CellSize, time, hitNormal) && time < first) {
+                first = time;
+                normal = hitNormal;
+                hit = cell;
             }
         }
+        GLboolean paddle = SweepCircle(center, radius, motion, this->Player->Position, this->Player->Position + this->Player->Size, time, hitNormal) && time <= first;
+        if (paddle) {
+            first = time;
+            normal = hitNormal;
+            hit = -1;
+        }
+
+        position += motion*first;
+        remaining -= remaining*first;
+        if (normal == glm::vec2(0.0f))
+            break; // nothing in the way
+        if (paddle) {
+            this->bouncePaddle(position, radius, velocity, stuck);
+            continue;
+        }
+        // reflect off the surface that was hit
+        velocity -= 2.0f*glm::dot(velocity, normal)*normal;
+        if (hit >= 0)
+            this->hitBrick(hit);
     }
+    Archetype &moved = this->Entities.Locate(ball, row);
+    moved.Position[row] = position;
+    moved.Velocity[row] = velocity;
+    moved.Stuck[row] = stuck;
+}
 
-    // Also check collisions for player pad (unless stuck)
-    Collision result = CheckCollision(*Ball, *Player);
-    if (!Ball->Stuck && std::get<0>(result))
-    {
-        // Check where it hit the board, and change velocity based on where it hit the board
-        GLfloat centerBoard = Player->Position.x + Player->Size.x / 2;
-        GLfloat distance = (Ball->Position.x + Ball->Radius) - centerBoard;
-        GLfloat percentage = distance / (Player->Size.x / 2);
-        // Then move accordingly
-        GLfloat strength = 2.0f;
-        glm::vec2 oldVelocity = Ball->Velocity;
-        Ball->Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
-        //Ball->Velocity.y = -Ball->Velocity.y;
-        Ball->Velocity = glm::normalize(Ball->Velocity) * glm::length(oldVelocity); // Keep speed consistent over both axes (multiply by length of old velocity, so total strength is not changed)
-        // Fix sticky paddle
-        Ball->Velocity.y = -1 * abs(Ball->Velocity.y);
-
-        // If Sticky powerup is activated, also stick ball to paddle once new velocity vectors were calculated
-        Ball->Stuck = Ball->Sticky;
-
-        if (!MUTE_AUDIO)
-            SoundEngine->play2D("audio/bleep.wav", GL_FALSE);
+void Game::hitBrick(GLuint cell) {
+    BrickField &bricks = this->Levels[this->Level].Bricks;
+    // Destroy block if not solid
+    if (!bricks.IsSolid(cell)) {
+        bricks.Destroy(cell);
+        this->SpawnPowerUps(bricks.Position(cell));
+        this->Events.push_back(EVENT_BRICK_DESTROYED);
+    } else {
+        this->ShakeTime = 0.05f;
+        this->Shake = GL_TRUE;
+        this->Events.push_back(EVENT_SOLID_HIT);
     }
 }
 
-void Game::ResetLevel() {
-    if (this->Level == 0) {
-        this->Levels[0].Load("levels/one.lvl", this->Width, this->Height * 0.5f);
-    } else if (this->Level == 1) {
-        this->Levels[1].Load("levels/two.lvl", this->Width, this->Height * 0.5f);
-    } else if (this->Level == 2) {
-        this->Levels[2].Load("levels/three.lvl", this->Width, this->Height * 0.5f);
-    } else if (this->Level == 3) {
-        this->Levels[3].Load("levels/four.lvl", this->Width, this->Height * 0.5f);
+void Game::bouncePaddle(glm::vec2 position, GLfloat radius, glm::vec2 &velocity, GLboolean &stuck) {
+    // Check where it hit the board, and change velocity based on where it hit the board
+    GLfloat centerBoard = this->Player->Position.x + this->Player->Size.x / 2;
+    GLfloat distance = (position.x + radius) - centerBoard;
+    GLfloat percentage = distance / (this->Player->Size.x / 2);
+    // Then move accordingly
+    GLfloat strength = 2.0f;
+    glm::vec2 oldVelocity = velocity;
+    velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
+    //velocity.y = -velocity.y;
+    velocity = glm::normalize(velocity) * glm::length(oldVelocity); // Keep speed consistent over both axes (multiply by length of old velocity, so total strength is not changed)
+    // Fix sticky paddle
+    velocity.y = -1 * abs(velocity.y);
+
+    // If Sticky powerup is activated, also stick ball to paddle once new velocity vectors were calculated
+    stuck = this->Sticky;
+
+    this->Events.push_back(EVENT_PADDLE_HIT);
+}
+
+void Game::collectPowerUps() {
+    // Collided with player, now activate powerup and keep it around until its effect ends
+    this->hits.clear();
+    OverlapEntities(this->Entities, COLLIDE_PADDLE, this->Player->Position, this->Player->Position + this->Player->Size, this->hits);
+    for (Entity entity : this->hits) {
+        GLuint row;
+        GLuint type = this->Entities.Locate(entity, row).PowerUpType[row];
+        this->ActivatePowerUp(type);
+        this->Entities.SetComponents(entity, POWERUP_ACTIVE);
+        this->Entities.Locate(entity, row).Lifetime[row] = this->PowerUpTypes.Types[type].Duration;
+        this->Events.push_back(EVENT_POWERUP);
     }
+    // Power ups that passed the bottom edge are gone
+    CullEntities(this->Entities, this->Height);
+}
+
+void Game::ResetLevel() {
+    this->Levels[this->Level].Reset();
 
     this->Lives = 3;
 }
 
 void Game::ResetPlayer() {
-    Player->Size = PLAYER_SIZE;
-    Player->Position = glm::vec2(this->Width / 2 - PLAYER_SIZE.x / 2, this->Height - PLAYER_SIZE.y);
-    Ball->Reset(Player->Position + glm::vec2(PLAYER_SIZE.x / 2 - BALL_RADIUS, -(BALL_RADIUS * 2)), INITIAL_BALL_VELOCITY);
-
-    Effects->Chaos = GL_FALSE;
-    Effects->Confuse = GL_FALSE;
-    Ball->PassThrough = GL_FALSE;
-    Ball->Sticky = GL_FALSE;
-    Player->Color = glm::vec3(1.0f);
-    Ball->Color = glm::vec3(1.0f);
-}
-
-void Game::SpawnPowerUps(GameObject &block) {
-    if (ShouldSpawn(75)) // 1 in 75 chance
-        this->PowerUps.push_back(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, block.Position, ResourceManager::GetTexture("powerup_speed")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position, ResourceManager::GetTexture("powerup_sticky")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position, ResourceManager::GetTexture("powerup_passthrough")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4), 0.0f, block.Position, ResourceManager::GetTexture("powerup_increase")));
-    if (ShouldSpawn(15)) // Negative powerups should spawn more often
-        this->PowerUps.push_back(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_confuse")));
-    if (ShouldSpawn(15))
-        this->PowerUps.push_back(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_chaos")));
+    this->Player->Size = PLAYER_SIZE;
+    this->Player->Position = glm::vec2(this->Width / 2 - PLAYER_SIZE.x / 2, this->Height - PLAYER_SIZE.y);
+    this->Player->PrevPosition = this->Player->Position;
+    this->collectBalls();
+    for (Entity ball : this->balls)
+        this->Entities.Destroy(ball);
+    this->Ball = this->SpawnBall(this->Player->Position + glm::vec2(PLAYER_SIZE.x / 2 - BALL_RADIUS, -(BALL_RADIUS * 2)), INITIAL_BALL_VELOCITY, GL_TRUE);
+
+    this->Chaos = GL_FALSE;
+    this->Confuse = GL_FALSE;
+    this->PassThrough = GL_FALSE;
+    this->Sticky = GL_FALSE;
+    this->Player->Color = glm::vec3(1.0f);
+}
+
+Entity Game::SpawnBall(glm::vec2 position, glm::vec2 velocity, GLboolean stuck) {
+    GLuint row;
+    Entity ball = this->Entities.Create(BALL_ENTITY);
+    Archetype &archetype = this->Entities.Locate(ball, row);
+    archetype.Position[row] = position;
+    archetype.PrevPosition[row] = position;
+    archetype.Extent[row] = glm::vec2(BALL_RADIUS*2.0f);
+    archetype.Velocity[row] = velocity;
+    archetype.Sprite[row] = this->ballSprite;
+    archetype.Color[row] = glm::vec3(1.0f);
+    archetype.Radius[row] = BALL_RADIUS;
+    archetype.Stuck[row] = stuck;
+    return ball;
+}
+
+void Game::collectBalls() {
+    this->balls.clear();
+    for (const Archetype &archetype : this->Entities.Archetypes) {
+        if (!archetype.Has(COMPONENT_BALL))
+            continue;
+        for (GLuint row = 0; row < archetype.Size(); ++row) {
+            if (archetype.IsAlive(row))
+                this->balls.push_back(this->Entities.At(archetype, row));
+        }
+    }
+}
+
+void Game::carryBalls(GLfloat dx) {
+    for (Archetype &archetype : this->Entities.Archetypes) {
+        if (!archetype.Has(COMPONENT_BALL))
+            continue;
+        for (GLuint row = 0; row < archetype.Size(); ++row) {
+            if (archetype.Stuck[row])
+                archetype.Position[row].x += dx;
+        }
+    }
+}
+
+void Game::SpawnPowerUps(glm::vec2 position) {
+    // roll for every type in the order of the data file, a brick can drop several
+    for (GLuint type = 0; type < this->PowerUpTypes.Types.size(); ++type) {
+        const PowerUpType &info = this->PowerUpTypes.Types[type];
+        if (!ShouldSpawn(info.Chance))
+            continue;
+        GLuint row;
+        Archetype &archetype = this->Entities.Locate(this->Entities.Create(POWERUP_FALLING), row);
+        archetype.Position[row] = position;
+        archetype.PrevPosition[row] = position;
+        archetype.Extent[row] = SIZE;
+        archetype.Velocity[row] = VELOCITY;
+        archetype.Sprite[row] = this->Entities.AddSprite(info.Sprite);
+        archetype.Color[row] = info.Color;
+        archetype.Collider[row] = COLLIDE_PADDLE;
+        archetype.PowerUpType[row] = type;
+    }
 }
 
 void Game::UpdatePowerUps(GLfloat dt) {
-    for (PowerUp &powerUp : this->PowerUps) {
-        powerUp.Position += powerUp.Velocity * dt;
-        if (powerUp.Activated) {
-            powerUp.Duration -= dt;
-
-            if (powerUp.Duration <= 0.0f) {
-                // Remove powerup from list (will later be removed)
-                powerUp.Activated = GL_FALSE;
-                // Deactivate effects
-                if (powerUp.Type == "sticky") {
-                    // Only reset if no other PowerUp of type sticky is active
-                    if (!IsOtherPowerUpActive(this->PowerUps, "sticky")) {
-                        Ball->Sticky = GL_FALSE;
-                        Player->Color = glm::vec3(1.0f);
-                    }
-                } else if (powerUp.Type == "pass-through") {
-                    // Only reset if no other PowerUp of type pass-through is active
-                    if (!IsOtherPowerUpActive(this->PowerUps, "pass-through")) {
-                        Ball->PassThrough = GL_FALSE;
-                        Ball->Color = glm::vec3(1.0f);
-                    }
-                } else if (powerUp.Type == "confuse") {
-                    // Only reset if no other PowerUp of type confuse is active
-                    if (!IsOtherPowerUpActive(this->PowerUps, "confuse")) {
-                        Effects->Confuse = GL_FALSE;
-                    }
-                } else if (powerUp.Type == "chaos") {
-                    // Only reset if no other PowerUp of type chaos is active
-                    if (!IsOtherPowerUpActive(this->PowerUps, "chaos")) {
-                        Effects->Chaos = GL_FALSE;
-                    }
-                }
-            }
+    MoveEntities(this->Entities, dt);
+    this->expired.clear();
+    AgeEntities(this->Entities, dt, this->expired);
+    for (Entity entity : this->expired) {
+        GLuint row;
+        Archetype &archetype = this->Entities.Locate(entity, row);
+        if (archetype.Has(COMPONENT_POWERUP)) {
+            // Only reset the effect if no other PowerUp of this type is active
+            PowerUpType &type = this->PowerUpTypes.Types[archetype.PowerUpType[row]];
+            PowerUpHook deactivate = this->PowerUpTypes.Effects[type.Effect].Deactivate;
+            if (--type.Active == 0 && deactivate)
+                deactivate(*this);
         }
+        this->Entities.Destroy(entity);
     }
-    // Remove all PowerUps from vector that are destroyed AND !activated (thus either off the map or finished)
-    // Note we use a lambda expression to remove each PowerUp which is destroyed and not activated
-    this->PowerUps.erase(std::remove_if(this->PowerUps.begin(), this->PowerUps.end(),
-        [](const PowerUp &powerUp) { return powerUp.Destroyed && !powerUp.Activated; }
-    ), this->PowerUps.end());
+    // Pack the entities that were picked up, fell off the map or finished
+    this->Entities.Flush();
 }
 
 GLboolean ShouldSpawn(GLuint chance) {
@@ -421,84 +480,154 @@ GLboolean ShouldSpawn(GLuint chance) {
     return random == 0;
 }
 
-void ActivatePowerUp(PowerUp &powerUp) {
+void Game::ActivatePowerUp(GLuint type) {
     // Initiate a powerup based type of powerup
-    if (powerUp.Type == "speed") {
-        Ball->Velocity *= 1.2;
-    } else if (powerUp.Type == "sticky") {
-        Ball->Sticky = GL_TRUE;
-        Player->Color = glm::vec3(1.0f, 0.5f, 1.0f);
-    } else if (powerUp.Type == "pass-through") {
-        Ball->PassThrough = GL_TRUE;
-        Ball->Color = glm::vec3(1.0f, 0.5f, 0.5f);
-    } else if (powerUp.Type == "pad-size-increase") {
-        Player->Size.x += 50;
-    } else if (powerUp.Type == "confuse") {
-        if (!Effects->Chaos)
-            Effects->Confuse = GL_TRUE; // Only activate if chaos wasn't already active
-    } else if (powerUp.Type == "chaos") {
-        if (!Effects->Confuse)
-            Effects->Chaos = GL_TRUE;
+    PowerUpType &info = this->PowerUpTypes.Types[type];
+    ++info.Active;
+    this->PowerUpTypes.Effects[info.Effect].Activate(*this);
+}
+
+void ActivateSpeed(Game &game) {
+    for (Archetype &archetype : game.Entities.Archetypes) {
+        if (!archetype.Has(COMPONENT_BALL))
+            continue;
+        for (glm::vec2 &velocity : archetype.Velocity)
+            velocity *= 1.2;
     }
 }
 
-GLboolean IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type) {
-    // Check if another PowerUp of the same type is still active
-    // in which case we don't disable its effect (yet)
-    for (const PowerUp &powerUp : powerUps) {
-        if (powerUp.Activated)
-            if (powerUp.Type == type)
-                return GL_TRUE;
+void ActivateSticky(Game &game) {
+    game.Sticky = GL_TRUE;
+    game.Player->Color = glm::vec3(1.0f, 0.5f, 1.0f);
+}
+
+void DeactivateSticky(Game &game) {
+    game.Sticky = GL_FALSE;
+    game.Player->Color = glm::vec3(1.0f);
+}
+
+void ActivatePassThrough(Game &game) {
+    game.PassThrough = GL_TRUE;
+    ColorBalls(game, glm::vec3(1.0f, 0.5f, 0.5f));
+}
+
+void DeactivatePassThrough(Game &game) {
+    game.PassThrough = GL_FALSE;
+    ColorBalls(game, glm::vec3(1.0f));
+}
+
+void ActivatePadSizeIncrease(Game &game) {
+    game.Player->Size.x += 50;
+}
+
+void ActivateConfuse(Game &game) {
+    if (!game.Chaos)
+        game.Confuse = GL_TRUE; // Only activate if chaos wasn't already active
+}
+
+void DeactivateConfuse(Game &game) {
+    game.Confuse = GL_FALSE;
+}
+
+void ActivateChaos(Game &game) {
+    if (!game.Confuse)
+        game.Chaos = GL_TRUE;
+}
+
+void DeactivateChaos(Game &game) {
+    game.Chaos = GL_FALSE;
+}
+
+void ColorBalls(Game &game, glm::vec3 color) {
+    for (Archetype &archetype : game.Entities.Archetypes) {
+        if (archetype.Has(COMPONENT_BALL))
+            std::fill(archetype.Color.begin(), archetype.Color.end(), color);
     }
-    return GL_FALSE;
-}
-
-GLboolean CheckCollision(GameObject &one, GameObject &two) {
-    // Collision x-axis?
-    bool collisionX = one.Position.x + one.Size.x >= two.Position.x &&
-        two.Position.x + two.Size.x >= one.Position.x;
-    // Collision y-axis?
-    bool collisionY = one.Position.y + one.Size.y >= two.Position.y &&
-        two.Position.y + two.Size.y >= one.Position.y;
-    // Collision only if on both axes
-    return collisionX && collisionY;
-}
-
-Collision CheckCollision(BallObject &one, GameObject &two) { // AABB - Circle collision
-    // Get center point circle first
-    glm::vec2 center(one.Position + one.Radius);
-    // Calculate AABB info (center, half-extents)
-    glm::vec2 aabb_half_extents(two.Size.x / 2, two.Size.y / 2);
-    glm::vec2 aabb_center(two.Position.x + aabb_half_extents.x, two.Position.y + aabb_half_extents.y);
-    // Get difference vector between both centers
-    glm::vec2 difference = center - aabb_center;
-    glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
-    // Now that we know the the clamped values, add this to AABB_center and we get the value of box closest to circle
-    glm::vec2 closest = aabb_center + clamped;
-    // Now retrieve vector between center circle and closest point AABB and check if length < radius
-    difference = closest - center;
-
-    if (glm::length(difference) < one.Radius) // not <= since in that case a collision also occurs when object one exactly touches object two, which they are at the end of each collision resolution stage.
-        return std::make_tuple(GL_TRUE, VectorDirection(difference), difference);
+}
+
+Collision CheckCollision(glm::vec2 position, GLfloat radius, glm::vec2 min, glm::vec2 max) {
+    glm::vec2 difference;
+    if (CircleOverlapsBox(position + radius, radius, min, max, difference))
+        return std::make_tuple(GL_TRUE, HitFace(difference), difference);
     else
         return std::make_tuple(GL_FALSE, UP, glm::vec2(0, 0));
 }
 
-Direction VectorDirection(glm::vec2 target) {
-    glm::vec2 compass[] = {
-        glm::vec2(0.0f, 1.0f),  // up
-        glm::vec2(1.0f, 0.0f),  // right
-        glm::vec2(0.0f, -1.0f), // down
-        glm::vec2(-1.0f, 0.0f)  // left
-    };
-    GLfloat max = 0.0f;
-    GLuint best_match = -1;
-    for (GLuint i = 0; i < 4; i++) {
-        GLfloat dot_product = glm::dot(glm::normalize(target), compass[i]);
-        if (dot_product > max) {
-            max = dot_product;
-            best_match = i;
+// Time of impact of a circle moving by motion against an AABB, as a fraction
+// of motion. Only impacts where the circle moves into the box are reported,
+// a circle that already overlaps the box hits it at time 0 unless it is
+// moving away from it.
+GLboolean SweepCircle(glm::vec2 center, GLfloat radius, glm::vec2 motion, glm::vec2 boxMin, glm::vec2 boxMax, GLfloat &time, glm::vec2 &normal) {
+    // already touching, push out along the closest point like the discrete test
+    glm::vec2 closest = glm::clamp(center, boxMin, boxMax);
+    glm::vec2 difference = center - closest;
+    if (glm::dot(difference, difference) < radius*radius) {
+        if (difference == glm::vec2(0.0f)) {
+            // centre inside the box, leave through the nearest side
+            glm::vec2 low = center - boxMin, high = boxMax - center;
+            glm::vec2 depth = glm::min(low, high);
+            if (depth.x < depth.y)
+                normal = glm::vec2(low.x < high.x ? -1.0f : 1.0f, 0.0f);
+            else
+                normal = glm::vec2(0.0f, low.y < high.y ? -1.0f : 1.0f);
+        } else {
+            normal = glm::normalize(difference);
         }
+        time = 0.0f;
+        return glm::dot(motion, normal) < 0.0f;
+    }
+
+    // ray against the box grown by the radius (slab test)
+    glm::vec2 growMin = boxMin - radius, growMax = boxMax + radius;
+    GLfloat enter = 0.0f, exit = 1.0f;
+    glm::vec2 enterNormal(0.0f);
+    for (GLuint axis = 0; axis < 2; ++axis) {
+        if (motion[axis] == 0.0f) {
+            if (center[axis] < growMin[axis] || center[axis] > growMax[axis])
+                return GL_FALSE;
+            continue;
+        }
+        GLfloat near = (growMin[axis] - center[axis]) / motion[axis];
+        GLfloat far = (growMax[axis] - center[axis]) / motion[axis];
+        GLfloat side = -1.0f;
+        if (near > far) {
+            std::swap(near, far);
+            side = 1.0f;
+        }
+        if (near > enter) {
+            enter = near;
+            enterNormal = glm::vec2(0.0f);
+            enterNormal[axis] = side;
+        }
+        exit = glm::min(exit, far);
+        if (enter > exit)
+            return GL_FALSE;
+    }
+    if (enterNormal == glm::vec2(0.0f))
+        return GL_FALSE;
+
+    // the grown box has square corners, the real shape has round ones
+    glm::vec2 contact = center + motion*enter;
+    glm::vec2 outside = glm::vec2(contact.x < boxMin.x ? -1.0f : (contact.x > boxMax.x ? 1.0f : 0.0f),
+        contact.y < boxMin.y ? -1.0f : (contact.y > boxMax.y ? 1.0f : 0.0f));
+    if (outside.x != 0.0f && outside.y != 0.0f) {
+        // entered through a corner region, intersect with the corner circle instead
+        glm::vec2 corner(outside.x < 0.0f ? boxMin.x : boxMax.x, outside.y < 0.0f ? boxMin.y : boxMax.y);
+        glm::vec2 offset = center - corner;
+        GLfloat a = glm::dot(motion, motion);
+        GLfloat b = glm::dot(offset, motion);
+        GLfloat c = glm::dot(offset, offset) - radius*radius;
+        GLfloat discriminant = b*b - a*c;
+        if (discriminant < 0.0f)
+            return GL_FALSE;
+        GLfloat t = (-b - std::sqrt(discriminant)) / a;
+        if (t < 0.0f || t > 1.0f)
+            return GL_FALSE;
+        time = t;
+        normal = glm::normalize(offset + motion*t);
+        return GL_TRUE;
     }
-    return (Direction)best_match;
+    time = enter;
+    normal = enterNormal;
+    return GL_TRUE;
 }
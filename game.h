@@ -14,11 +14,12 @@
 #include <tuple>
 
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
 #include "game_object.h"
+#include "collision_kernel.h"
 #include "game_level.h"
+#include "entity_world.h"
 #include "power_up.h"
 
 enum GameState {
@@ -28,12 +29,33 @@ enum GameState {
     GAME_LOSS
 };
 
-// collision directions
-enum Direction {
-    UP,
-    RIGHT,
-    DOWN,
-    LEFT
+// key codes read by the game, the values match the GLFW_KEY_* constants
+const GLuint KEY_SPACE = 32;
+const GLuint KEY_A = 65;
+const GLuint KEY_D = 68;
+const GLuint KEY_S = 83;
+const GLuint KEY_W = 87;
+const GLuint KEY_ENTER = 257;
+
+// things that happened during a tick which the presentation reacts to
+enum GameEvent {
+    EVENT_BRICK_DESTROYED,
+    EVENT_SOLID_HIT,
+    EVENT_POWERUP,
+    EVENT_PADDLE_HIT
+};
+
+// How the ball is moved and collided each tick
+enum CollisionMode {
+    COLLISION_DISCRETE,     // move the full step, then push out of overlapping objects
+    COLLISION_CONTINUOUS    // advance to the earliest time of impact, reflect and continue
+};
+
+// A ball at the end of a tick, the presentation leaves its trail there
+struct BallTrail {
+    GLfloat Time;
+    glm::vec2 Position, Velocity;
+    GLfloat Radius;
 };
 
 // Defines a Collision typedef that represents collision data
@@ -45,8 +67,20 @@ const GLfloat PLAYER_VELOCITY(500.0f);
 
 const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
 const GLfloat BALL_RADIUS = 12.5f;
+// Components of a ball in the EntityWorld
+const ComponentMask BALL_ENTITY = COMPONENT_TRANSFORM | COMPONENT_VELOCITY | COMPONENT_SPRITE | COMPONENT_BALL;
+// Upper bound on the impacts resolved for the ball in a single tick
+const GLuint MAX_SWEEP_ITERATIONS = 8;
+
+// simulation runs in fixed steps of 1/TICK_RATE seconds, frames longer
+// than MAX_FRAME_TIME are cut short so a hitch can't queue up endless ticks
+const GLfloat TICK_RATE = 120.0f;
+const GLfloat MAX_FRAME_TIME = 0.25f;
+// seconds of every frame spent on uploading assets while the game starts
+const GLdouble ASSET_FRAME_BUDGET = 0.004;
 
 const GLboolean MUTE_AUDIO = GL_FALSE;
+const GLboolean SHOW_DRAW_STATS = GL_FALSE;
 
 class Game {
 public:
@@ -59,29 +93,90 @@ public:
     std::vector<GameLevel> Levels;
     GLuint Level;
     GLuint Lives;
-
-    std::vector<PowerUp> PowerUps;
+    CollisionMode Collisions;
+
+    // Balls, power ups and any other short lived objects
+    EntityWorld Entities;
+    // Kinds of power up that can drop, loaded from data/powerups.txt
+    PowerUpRegistry PowerUpTypes;
+
+    // There is only ever one paddle, it stays a plain object
+    GameObject* Player;
+    // Ball served from the paddle at the start of every life, any number of
+    // balls can be in play in Entities and a life is lost with the last one
+    Entity Ball;
+    // Ball effects of the active power ups, they apply to every ball
+    GLboolean Sticky, PassThrough;
+
+    // Screen effects requested by the simulation
+    GLboolean Confuse, Chaos, Shake;
+    GLfloat ShakeTime;
+    // Simulated time in seconds
+    GLfloat Time;
+    // Events and ball trails since the presentation last consumed them
+    std::vector<GameEvent> Events;
+    std::vector<BallTrail> Trails;
 
     // class constructor destructor
     Game(GLuint width, GLuint height);
     ~Game();
 
-    // Initalize game and assets
-    void Init();
+    // Initalize levels and objects, sprites are taken from the loaded assets.
+    // Fails if the levels or power ups can't be loaded, the game can't be played then.
+    GLboolean Init();
+    // Load and release textures, shaders, renderers and audio (not part of headless builds).
+    // LoadAssets only starts loading, call UpdateAssets every frame until it returns true
+    // before Init, it spends at most budget seconds per call on the GL thread.
+    void LoadAssets();
+    GLboolean UpdateAssets(GLdouble budget);
+    void UnloadAssets();
 
     // Game loop functions
+    // Advance the simulation one fixed step: input, movement and collisions
+    void Tick(GLfloat dt);
     void ProcessInput(GLfloat dt);
     void Update(GLfloat dt);
     void DoCollisions();
-    void Render();
+    // Move every ball through the tick stopping at every impact (COLLISION_CONTINUOUS)
+    void SweepBalls(GLfloat dt);
+    // alpha is the fraction of a tick left over in the accumulator (not part of headless builds)
+    void Render(GLfloat alpha=1.0f);
 
     // Reset
     void ResetLevel();
+    // Put the paddle back and replace every ball in play with one stuck to it
     void ResetPlayer();
+    // Add a ball to the game, a stuck ball rides on the paddle until it is launched
+    Entity SpawnBall(glm::vec2 position, glm::vec2 velocity, GLboolean stuck=GL_FALSE);
 
     // PowerUps
-    void SpawnPowerUps(GameObject &block);
+    // Roll for power ups dropping from a destroyed brick at position
+    void SpawnPowerUps(glm::vec2 position);
     void UpdatePowerUps(GLfloat dt);
+    void ActivatePowerUp(GLuint type);
+
+private:
+    // Bricks near the ball, filled by the broadphase every tick
+    std::vector<GLuint> candidates;
+    // Entities reported by the systems this tick
+    std::vector<Entity> hits, expired;
+    // Balls in play, in the order they were added
+    std::vector<Entity> balls;
+    // Index of the ball texture in Entities.Sprites
+    GLuint ballSprite;
+
+    // Fill balls with every ball that is alive
+    void collectBalls();
+    // Slide the balls stuck to the paddle by dx along with it
+    void carryBalls(GLfloat dx);
+    // Sweep a single ball through dt
+    void sweepBall(Entity ball, GLfloat dt);
+    // Responses shared by both collision modes
+    void hitBrick(GLuint cell);
+    void bouncePaddle(glm::vec2 position, GLfloat radius, glm::vec2 &velocity, GLboolean &stuck);
+    void collectPowerUps();
+    // Play the sounds of the events since the last frame
+    void playEvents();
 };
 
 #endif
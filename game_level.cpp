@@ -9,82 +9,82 @@
 #include "game_level.h"
 
 #include <fstream>
+#include <iostream>
 #include <sstream>
+#include <string>
 
-void GameLevel::Load(const GLchar* file, GLuint levelWidth, GLuint levelHeight) {
-    // reset
-    this->Bricks.clear();
+#include "level_file.h"
+#include "resource_names.h"
 
-    GLuint tileCode;
-    std::string line;
-    std::ifstream fstream(file);
-    std::vector<std::vector<GLuint>> tileData;
-    if (fstream) {
-        while (std::getline(fstream, line)) {
-            std::istringstream sstream(line);
-            std::vector<GLuint> row;
-            // add each tile to row
-            while (sstream >> tileCode)
-                row.push_back(tileCode);
-            tileData.push_back(row);
-        }
+GLboolean GameLevel::Load(const GLchar* file, GLuint levelWidth, GLuint levelHeight) {
+    // reset
+    this->Bricks.Clear();
+    this->BlockSprite = GetSprite(TEXTURE_BLOCK);
+    this->SolidSprite = GetSprite(TEXTURE_BLOCK_SOLID);
 
-        if (tileData.size() > 0)
-            this->init(tileData, levelWidth, levelHeight);
+    std::string path(file);
+    if (path.size() > 5 && path.compare(path.size() - 5, 5, ".blvl") == 0) {
+        // compiled by lvlc, the tiles are copied straight out of the mapped file
+        LevelFile level;
+        if (!level.Open(file))
+            return GL_FALSE;
+        this->Bricks.Init(level.Tiles, level.Header->Width, level.Header->Height, level.Header->Destructible, levelWidth, levelHeight);
+    } else {
+        std::vector<GLubyte> tiles;
+        GLuint width, height;
+        if (!ReadTextLevel(file, tiles, width, height))
+            return GL_FALSE;
+        this->Bricks.Init(tiles.data(), width, height, CountDestructible(tiles.data(), tiles.size()), levelWidth, levelHeight);
     }
-}
-
-void GameLevel::Draw(SpriteRenderer &renderer) {
-    for (GameObject &tile : this->Bricks) {
-        if (!tile.Destroyed)
-            tile.Draw(renderer);
+    // the level is won once every destructible brick is gone, without any it would be won right away
+    if (this->Bricks.Destructible == 0) {
+        std::cout << "ERROR::LEVEL: No destructible bricks in level: " << file << std::endl;
+        return GL_FALSE;
     }
+    return GL_TRUE;
 }
 
-GLboolean GameLevel::IsCompleted() {
-    for (GameObject &tile : this->Bricks) {
-        if (!tile.IsSolid && !tile.Destroyed)
+GLboolean LoadLevels(const GLchar* manifest, GLuint levelWidth, GLuint levelHeight, std::vector<GameLevel> &levels) {
+    levels.clear();
+    std::ifstream fstream(manifest);
+    if (!fstream) {
+        std::cout << "ERROR::LEVEL: Failed to read level manifest: " << manifest << std::endl;
+        return GL_FALSE;
+    }
+    std::string line, path;
+    while (std::getline(fstream, line)) {
+        std::istringstream sstream(line.substr(0, line.find('#')));
+        if (!(sstream >> path))
+            continue;
+        levels.emplace_back();
+        if (!levels.back().Load(path.c_str(), levelWidth, levelHeight)) {
+            levels.clear();
             return GL_FALSE;
+        }
+    }
+    if (levels.empty()) {
+        std::cout << "ERROR::LEVEL: No levels in manifest: " << manifest << std::endl;
+        return GL_FALSE;
     }
     return GL_TRUE;
 }
 
-void GameLevel::init(std::vector<std::vector<GLuint>> tileData, GLuint levelWidth, GLuint levelHeight) {
-    GLuint height = tileData.size();
-    GLuint width = tileData[0].size();
-    GLfloat unit_width = levelWidth/static_cast<GLfloat>(width);
-    GLfloat unit_height = levelHeight/static_cast<GLfloat>(height);
-
-    // initalize game objects
-    for (GLuint y=0; y < height; ++y) {
-        for (GLuint x=0; x < width; ++x) {
-            // do nothing if (tileData[y][x] == 0)
-            if(tileData[y][x] > 0) {
-                glm::vec2 pos(unit_width*x, unit_height*y);
-                glm::vec2 size(unit_width, unit_height);
-                std::string block_texture_name = "block";
-                glm::vec3 color;
-                GLboolean isSolid = GL_FALSE;
-
-                if (tileData[y][x] == 1) {
-                    color = glm::vec3(0.8f, 0.8f, 0.7f);
-                    block_texture_name = "block_solid";
-                    isSolid = GL_TRUE;
-                } else if (tileData[y][x] == 2) {
-                    color = glm::vec3(0.2f, 0.6f, 1.0f);
-                } else if (tileData[y][x] == 3) {
-                    color = glm::vec3(0.0f, 0.7f, 0.0f);
-                } else if (tileData[y][x] == 4) {
-                    color = glm::vec3(0.8f, 0.8f, 0.4f);
-                } else if (tileData[y][x] == 5) {
-                    color = glm::vec3(1.0f, 0.5f, 0.0f);
-                }
-
-                GameObject obj(pos, size, ResourceManager::GetTexture(block_texture_name), color);
-                obj.IsSolid = isSolid;
-                this->Bricks.push_back(obj);
-            }
+#ifndef BREAKOUT_HEADLESS
+void GameLevel::Draw(SpriteRenderer &renderer) {
+    for (GLuint cell = 0; cell < this->Bricks.Size(); ++cell) {
+        if (this->Bricks.IsAlive(cell)) {
+            const Texture2D &sprite = this->Bricks.IsSolid(cell) ? this->SolidSprite : this->BlockSprite;
+            renderer.DrawSprite(sprite, this->Bricks.Position(cell), this->Bricks.CellSize, 0.0f, this->Bricks.Color(cell));
         }
     }
 }
 
+void GameLevel::Draw(RenderQueue &queue) {
+    for (GLuint cell = 0; cell < this->Bricks.Size(); ++cell) {
+        if (this->Bricks.IsAlive(cell)) {
+            const Texture2D &sprite = this->Bricks.IsSolid(cell) ? this->SolidSprite : this->BlockSprite;
+            queue.DrawSprite(LAYER_OBJECTS, sprite, this->Bricks.Position(cell), this->Bricks.CellSize, 0.0f, this->Bricks.Color(cell));
+        }
+    }
+}
+#endif
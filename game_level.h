@@ -15,27 +15,36 @@
 #include <glm/glm.hpp>
 
 #include "game_object.h"
-#include "sprite_renderer.h"
-#include "resource_manager.h"
+#include "brick_field.h"
 
 
 // class to contain aload levels
 class GameLevel {
 public:
     // state variables
-    std::vector<GameObject> Bricks;
+    BrickField Bricks;
+    // Sprites of destructible and solid bricks
+    Texture2D BlockSprite, SolidSprite;
     // Constructor
     GameLevel() { }
 
-    void Load(const GLchar* file, GLuint levelWidth, GLuint levelHeight);
+    // Load a compiled .blvl level or a text level, scaled to fill the given area.
+    // Fails if the file can't be read or has no brick to destroy.
+    GLboolean Load(const GLchar* file, GLuint levelWidth, GLuint levelHeight);
+#ifndef BREAKOUT_HEADLESS
     void Draw(SpriteRenderer &renderer);
+    void Draw(RenderQueue &queue);
+#endif
 
+    // Restore the level as it was loaded, without touching the file again
+    void Reset() { this->Bricks.Reset(); }
     // Check if all non-solid tiles are destroyed
-    GLboolean IsCompleted();
-
-private:
-    // Initialize level
-    void init(std::vector<std::vector<GLuint>> tileData, GLuint levelWidth, GLuint levelHeight);
+    GLboolean IsCompleted() const { return this->Bricks.Remaining == 0; }
 };
 
+// Load the levels listed in a manifest in place, one path per line and '#'
+// starts a comment. Fails if the manifest lists no level or one of them
+// can't be loaded, the game can't be played without every one of them.
+GLboolean LoadLevels(const GLchar* manifest, GLuint levelWidth, GLuint levelHeight, std::vector<GameLevel> &levels);
+
 #endif
@@ -7,13 +7,34 @@
 ** option) any later version.
 ******************************************************************/
 #include "game_object.h"
+#ifndef BREAKOUT_HEADLESS
+#include "resource_manager.h"
+#endif
 
 GameObject::GameObject()
-    : Position(0, 0), Size(1, 1), Velocity(0.0f), Color(1.0f), Rotation(0.0f), Sprite(), IsSolid(false), Destroyed(false) { }
+    : Position(0, 0), Size(1, 1), Velocity(0.0f), PrevPosition(0, 0), Color(1.0f), Rotation(0.0f), Sprite(), IsSolid(false), Destroyed(false) { }
 
 GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color, glm::vec2 velocity)
-    : Position(pos), Size(size), Velocity(velocity), Color(color), Rotation(0.0f), Sprite(sprite), IsSolid(false), Destroyed(false) { }
+    : Position(pos), Size(size), Velocity(velocity), PrevPosition(pos), Color(color), Rotation(0.0f), Sprite(sprite), IsSolid(false), Destroyed(false) { }
 
+glm::vec2 GameObject::RenderPosition(GLfloat alpha) const {
+    return glm::mix(this->PrevPosition, this->Position, alpha);
+}
+
+#ifndef BREAKOUT_HEADLESS
 void GameObject::Draw(SpriteRenderer &renderer) {
     renderer.DrawSprite(this->Sprite, this->Position, this->Size, this->Rotation, this->Color);
 }
+
+void GameObject::Draw(RenderQueue &queue, GLfloat alpha) {
+    queue.DrawSprite(LAYER_OBJECTS, this->Sprite, this->RenderPosition(alpha), this->Size, this->Rotation, this->Color);
+}
+
+Texture2D GetSprite(ResourceID name) {
+    return ResourceManager::GetTexture(ResourceManager::FindTexture(name));
+}
+#else
+Texture2D GetSprite(ResourceID) {
+    return Texture2D();
+}
+#endif
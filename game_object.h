@@ -12,14 +12,22 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <string>
+
 #include "texture.h"
+#include "resource_id.h"
+#ifndef BREAKOUT_HEADLESS
 #include "sprite_renderer.h"
+#include "render_queue.h"
+#endif
 
 // Class for defining objects in breakout
 class GameObject {
 public:
     // State variables
     glm::vec2 Position, Size, Velocity;
+    // Position at the start of the current simulation tick, used to interpolate rendering
+    glm::vec2 PrevPosition;
     glm::vec3 Color;
     GLfloat Rotation;
     GLboolean IsSolid, Destroyed;
@@ -29,7 +37,16 @@ public:
     GameObject();
     GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color=glm::vec3(1.0f), glm::vec2 velocity=glm::vec2(0.0f, 0.0f));
 
-    virtual void Draw(SpriteRenderer &renderer);
+    // Position blended between the previous and current tick
+    glm::vec2 RenderPosition(GLfloat alpha) const;
+#ifndef BREAKOUT_HEADLESS
+    void Draw(SpriteRenderer &renderer);
+    // alpha is the fraction of a tick elapsed since the last update
+    void Draw(RenderQueue &queue, GLfloat alpha=1.0f);
+#endif
 };
 
+// Texture used to draw a sprite, headless builds have no textures and get an empty one
+Texture2D GetSprite(ResourceID name);
+
 #endif
@@ -0,0 +1,219 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include <sstream>
+#include <iostream>
+
+#include <GLFW/glfw3.h>
+#include <irrklang/irrKlang.h>
+
+#include "game.h"
+#include "resource_manager.h"
+#include "resource_names.h"
+#include "asset_loader.h"
+#include "text_renderer.h"
+#include "sprite_batch.h"
+#include "render_queue.h"
+#include "post_processor.h"
+#include "frame_uniforms.h"
+#include "gl_state.h"
+#include "particle_generator.h"
+
+// Presentation of the game: assets, rendering and audio. The simulation in
+// game.cpp doesn't depend on anything in here.
+SpriteBatch* Batch;
+RenderQueue* Queue;
+ParticleGenerator* Particles;
+PostProcessor* Effects;
+FrameUniforms* Frame;
+TextRenderer* Text;
+irrklang::ISoundEngine* SoundEngine;
+// only exists while the assets are loading
+AssetLoader* Loader;
+std::shared_future<FontRaster> Font;
+// resources drawn every frame, resolved once the assets are loaded
+TextureHandle BackgroundTexture, ParticleTexture;
+ShaderHandle ParticleShader;
+// simulated time the particles were last advanced to
+GLfloat ParticleTime = 0.0f;
+// HUD strings, laid out once in LoadAssets and drawn by handle
+GLuint LivesText, StartText, SelectText, LossText, LossRetryText, WinText, WinRetryText;
+GLuint DisplayedLives;
+
+void Game::LoadAssets() {
+    // decoding and file reads run on the loader's workers, UpdateAssets finishes them
+    Loader = new AssetLoader();
+    // Load shaders
+    Loader->LoadShader("shaders/sprite_batch.vert", "shaders/sprite_batch.frag", "", SHADER_SPRITE_BATCH);
+    Loader->LoadShader("shaders/particle.vert", "shaders/particle.frag", "", SHADER_PARTICLE);
+    Loader->LoadShader("shaders/post_processing.vert", "shaders/post_processing.frag", "", SHADER_POST_PROCESSING);
+
+    // Load Textures
+    Loader->LoadTexture("textures/background.jpg", TEXTURE_BACKGROUND);
+    // sprites share atlas pages so they can be drawn without texture switches
+    Loader->LoadAtlasTexture("textures/awesomeface.png", TEXTURE_FACE);
+    Loader->LoadAtlasTexture("textures/paddle.png", TEXTURE_PADDLE);
+    Loader->LoadAtlasTexture("textures/block.png", TEXTURE_BLOCK);
+    Loader->LoadAtlasTexture("textures/block_solid.png", TEXTURE_BLOCK_SOLID);
+    Loader->LoadAtlasTexture("textures/particle.png", TEXTURE_PARTICLE);
+    Loader->LoadAtlasTexture("textures/powerup_speed.png", TEXTURE_POWERUP_SPEED);
+    Loader->LoadAtlasTexture("textures/powerup_sticky.png", TEXTURE_POWERUP_STICKY);
+    Loader->LoadAtlasTexture("textures/powerup_increase.png", TEXTURE_POWERUP_INCREASE);
+    Loader->LoadAtlasTexture("textures/powerup_confuse.png", TEXTURE_POWERUP_CONFUSE);
+    Loader->LoadAtlasTexture("textures/powerup_chaos.png", TEXTURE_POWERUP_CHAOS);
+    Loader->LoadAtlasTexture("textures/powerup_passthrough.png", TEXTURE_POWERUP_PASSTHROUGH);
+
+    // Load fonts, the shader has to match the render mode of the font
+    Loader->LoadShader("shaders/text.vert", "shaders/text_sdf.frag", "", SHADER_TEXT_SDF);
+    Font = Loader->LoadFont("fonts/OCRAEXT.TTF", 24, TEXT_SDF);
+
+    // audio
+    SoundEngine = irrklang::createIrrKlangDevice();
+    if (!MUTE_AUDIO)
+        SoundEngine->play2D("audio/breakout.mp3", GL_TRUE);
+}
+
+GLboolean Game::UpdateAssets(GLdouble budget) {
+    if (!Loader)
+        return GL_TRUE;
+    if (!Loader->Update(budget))
+        return GL_FALSE;
+    delete Loader;
+    Loader = nullptr;
+
+    // pass data to GPU, the projection is shared by all programs through the FrameData block
+    Frame = new FrameUniforms();
+    Frame->SetScreen(this->Width, this->Height);
+    Frame->Upload();
+    BackgroundTexture = ResourceManager::FindTexture(TEXTURE_BACKGROUND);
+    ParticleTexture = ResourceManager::FindTexture(TEXTURE_PARTICLE);
+    ParticleShader = ResourceManager::FindShader(SHADER_PARTICLE);
+    ResourceManager::GetShader(ParticleShader).Use().SetInteger("sprite", 0);
+
+    Particles = new ParticleGenerator(ResourceManager::GetShader(ParticleShader), ResourceManager::GetTexture(ParticleTexture), 500);
+    Batch = new SpriteBatch(ResourceManager::GetShader(ResourceManager::FindShader(SHADER_SPRITE_BATCH)));
+    Queue = new RenderQueue(*Batch);
+    Effects = new PostProcessor(ResourceManager::GetShader(ResourceManager::FindShader(SHADER_POST_PROCESSING)), this->Width, this->Height);
+    Text = new TextRenderer();
+    Text->Load(Font.get(), ResourceManager::GetShader(ResourceManager::FindShader(SHADER_TEXT_SDF)));
+    DisplayedLives = this->Lives;
+    LivesText = Text->CreateMesh("Lives:" + std::to_string(DisplayedLives), 5.0f, 5.0f, 1.0f);
+    StartText = Text->CreateMesh("Press ENTER to start", 250.0f, this->Height / 2, 1.0f);
+    SelectText = Text->CreateMesh("Press W or S to select level", 245.0f, this->Height / 2 + 20.0f, 0.75f);
+    LossText = Text->CreateMesh("You LOST :(", 320.0f, this->Height / 2 - 20.0f, 1.0f, glm::vec3(1.0f, 0.0f, 1.0f));
+    LossRetryText = Text->CreateMesh("Press ENTER to retry or ESC to quit", 130.0f, this->Height / 2, 1.0f, glm::vec3(0.0f, 0.0f, 1.0f));
+    WinText = Text->CreateMesh("You WON!!!", 320.0f, this->Height / 2 - 20.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+    WinRetryText = Text->CreateMesh("Press ENTER to retry or ESC to quit", 130.0f, this->Height / 2, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
+    return GL_TRUE;
+}
+
+void Game::UnloadAssets() {
+    delete Loader;
+    delete Batch;
+    delete Queue;
+    delete Particles;
+    delete Effects;
+    delete Frame;
+    delete Text;
+    SoundEngine->drop();
+}
+
+void Game::Render(GLfloat alpha) {
+    Batch->ResetStats();
+    GLState::ResetCounters();
+    // per frame shader state, one buffer write for every program
+    Frame->Data.Time = glfwGetTime();
+    Frame->Data.Confuse = this->Confuse;
+    Frame->Data.Chaos = this->Chaos;
+    Frame->Data.Shake = this->Shake;
+    Frame->Upload();
+    // replay the trails of the ticks since the last frame, the particles are
+    // aged by the simulated time between them so their density doesn't
+    // depend on the frame rate
+    for (const BallTrail &trail : this->Trails) {
+        if (trail.Time != ParticleTime) {
+            Particles->Update(trail.Time - ParticleTime);
+            ParticleTime = trail.Time;
+        }
+        Particles->Emit(trail.Position, trail.Velocity, 2, glm::vec2(trail.Radius/2));
+    }
+    this->Trails.clear();
+    Particles->Update(this->Time - ParticleTime);
+    ParticleTime = this->Time;
+    this->playEvents();
+    // configure OpenGL to render off screen
+    Effects->BeginRender();
+        // record the scene, draw order comes from the layer of each command
+        Queue->DrawSprite(LAYER_BACKGROUND, ResourceManager::GetTexture(BackgroundTexture), glm::vec2(0, 0), glm::vec2(this->Width, this->Height), 0.0f);
+        Queue->DrawCustom(LAYER_PARTICLES, BLEND_ADDITIVE, ResourceManager::GetShader(ParticleShader).ID, ResourceManager::GetTexture(ParticleTexture).ID,
+            []() { Particles->Draw(); });
+        this->Levels[this->Level].Draw(*Queue);
+        for (const Archetype &archetype : this->Entities.Archetypes) {
+            if (!archetype.Has(COMPONENT_TRANSFORM | COMPONENT_SPRITE))
+                continue;
+            for (GLuint row = 0; row < archetype.Size(); ++row) {
+                if (archetype.IsAlive(row))
+                    Queue->DrawSprite(LAYER_OBJECTS, this->Entities.Sprites[archetype.Sprite[row]], glm::mix(archetype.PrevPosition[row], archetype.Position[row], alpha),
+                        archetype.Extent[row], 0.0f, archetype.Color[row]);
+            }
+        }
+        this->Player->Draw(*Queue, alpha);
+        Queue->Submit();
+    // save render to texture and return OpenGL configuration to standard render
+    Effects->EndRender();
+    // render prerenderd scene to screen using postprocessing shaders
+    Effects->Render();
+    // dont include the text in the postprocessing
+    if (this->State == GAME_ACTIVE) {
+        // only lay the counter out again when it changed
+        if (this->Lives != DisplayedLives) {
+            DisplayedLives = this->Lives;
+            Text->UpdateMesh(LivesText, "Lives:" + std::to_string(DisplayedLives));
+        }
+        Text->DrawMesh(LivesText);
+    }
+
+    if (SHOW_DRAW_STATS) {
+        std::stringstream stream_draws; stream_draws << Batch->DrawCalls << " draws, " << Queue->CommandCount << " commands, " << Batch->SpriteCount << " sprites, "
+            << Particles->AliveCount() << " particles (" << Particles->SaturationCount() << " dropped), "
+            << GLState::Issued << " state calls (" << GLState::Elided << " elided)";
+        Text->QueueText(stream_draws.str(), 5.0f, this->Height - 20.0f, 0.75f);
+    }
+
+    if (this->State == GAME_MENU) {
+        Text->DrawMesh(StartText);
+        Text->DrawMesh(SelectText);
+    }
+
+    if (this->State == GAME_LOSS) {
+        Text->DrawMesh(LossText);
+        Text->DrawMesh(LossRetryText);
+    }
+
+    if (this->State == GAME_WIN) {
+        Text->DrawMesh(WinText);
+        Text->DrawMesh(WinRetryText);
+    }
+    Text->Flush();
+}
+
+void Game::playEvents() {
+    for (GameEvent event : this->Events) {
+        if (MUTE_AUDIO)
+            break;
+        if (event == EVENT_BRICK_DESTROYED)
+            SoundEngine->play2D("audio/bleep.mp3", GL_FALSE);
+        else if (event == EVENT_SOLID_HIT)
+            SoundEngine->play2D("audio/solid.wav", GL_FALSE);
+        else if (event == EVENT_POWERUP)
+            SoundEngine->play2D("audio/powerup.wav", GL_FALSE);
+        else if (event == EVENT_PADDLE_HIT)
+            SoundEngine->play2D("audio/bleep.wav", GL_FALSE);
+    }
+    this->Events.clear();
+}
@@ -0,0 +1,152 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "gl_state.h"
+
+// value that never matches a real binding, so the next call is always issued
+static const GLuint UNKNOWN = ~0u;
+
+GLuint GLState::Issued = 0;
+GLuint GLState::Elided = 0;
+
+GLuint GLState::program = UNKNOWN;
+GLuint GLState::activeUnit = UNKNOWN;
+GLuint GLState::textures[GL_STATE_TEXTURE_UNITS] = {
+    UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN,
+    UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN
+};
+GLuint GLState::vertexArray = UNKNOWN;
+GLuint GLState::arrayBuffer = UNKNOWN;
+GLenum GLState::blendSrc = UNKNOWN;
+GLenum GLState::blendDst = UNKNOWN;
+GLuint GLState::readFramebuffer = UNKNOWN;
+GLuint GLState::drawFramebuffer = UNKNOWN;
+
+void GLState::UseProgram(GLuint program) {
+    if (GLState::program == program) {
+        ++Elided;
+        return;
+    }
+    glUseProgram(program);
+    GLState::program = program;
+    ++Issued;
+}
+
+void GLState::BindTexture(GLuint unit, GLuint texture) {
+    // callers go on to modify the texture through the active unit, select it even when the bind is skipped
+    activeTexture(unit);
+    if (unit < GL_STATE_TEXTURE_UNITS && textures[unit] == texture) {
+        ++Elided;
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (unit < GL_STATE_TEXTURE_UNITS)
+        textures[unit] = texture;
+    ++Issued;
+}
+
+void GLState::BindVertexArray(GLuint vertexArray) {
+    if (GLState::vertexArray == vertexArray) {
+        ++Elided;
+        return;
+    }
+    glBindVertexArray(vertexArray);
+    GLState::vertexArray = vertexArray;
+    ++Issued;
+}
+
+void GLState::BindBuffer(GLenum target, GLuint buffer) {
+    if (target == GL_ARRAY_BUFFER) {
+        if (arrayBuffer == buffer) {
+            ++Elided;
+            return;
+        }
+        arrayBuffer = buffer;
+    }
+    glBindBuffer(target, buffer);
+    ++Issued;
+}
+
+void GLState::BlendFunc(GLenum sfactor, GLenum dfactor) {
+    if (blendSrc == sfactor && blendDst == dfactor) {
+        ++Elided;
+        return;
+    }
+    glBlendFunc(sfactor, dfactor);
+    blendSrc = sfactor;
+    blendDst = dfactor;
+    ++Issued;
+}
+
+void GLState::BindFramebuffer(GLenum target, GLuint framebuffer) {
+    GLboolean read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    GLboolean draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    if ((!read || readFramebuffer == framebuffer) && (!draw || drawFramebuffer == framebuffer)) {
+        ++Elided;
+        return;
+    }
+    glBindFramebuffer(target, framebuffer);
+    if (read)
+        readFramebuffer = framebuffer;
+    if (draw)
+        drawFramebuffer = framebuffer;
+    ++Issued;
+}
+
+void GLState::DeleteProgram(GLuint program) {
+    glDeleteProgram(program);
+    if (GLState::program == program)
+        GLState::program = UNKNOWN;
+}
+
+void GLState::DeleteTextures(GLsizei count, const GLuint* textures) {
+    glDeleteTextures(count, textures);
+    for (GLsizei i = 0; i < count; ++i) {
+        for (GLuint unit = 0; unit < GL_STATE_TEXTURE_UNITS; ++unit) {
+            if (GLState::textures[unit] == textures[i])
+                GLState::textures[unit] = UNKNOWN;
+        }
+    }
+}
+
+void GLState::DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays) {
+    glDeleteVertexArrays(count, vertexArrays);
+    for (GLsizei i = 0; i < count; ++i) {
+        if (vertexArray == vertexArrays[i])
+            vertexArray = UNKNOWN;
+    }
+}
+
+void GLState::DeleteBuffers(GLsizei count, const GLuint* buffers) {
+    glDeleteBuffers(count, buffers);
+    for (GLsizei i = 0; i < count; ++i) {
+        if (arrayBuffer == buffers[i])
+            arrayBuffer = UNKNOWN;
+    }
+}
+
+void GLState::ResetCounters() {
+    Issued = 0;
+    Elided = 0;
+}
+
+void GLState::Invalidate() {
+    program = activeUnit = vertexArray = arrayBuffer = UNKNOWN;
+    blendSrc = blendDst = UNKNOWN;
+    readFramebuffer = drawFramebuffer = UNKNOWN;
+    for (GLuint i = 0; i < GL_STATE_TEXTURE_UNITS; ++i)
+        textures[i] = UNKNOWN;
+}
+
+void GLState::activeTexture(GLuint unit) {
+    if (activeUnit == unit)
+        return;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    activeUnit = unit;
+    ++Issued;
+}
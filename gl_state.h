@@ -0,0 +1,59 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+// Number of texture units whose bindings are shadowed
+const GLuint GL_STATE_TEXTURE_UNITS = 16;
+
+// static singleton shadowing the OpenGL binding state. Calls that would
+// not change the current state are skipped. All binds in the renderer
+// must go through this class, otherwise call Invalidate afterwards.
+class GLState {
+public:
+    // Calls passed on to OpenGL and calls skipped since the last ResetCounters
+    static GLuint Issued;
+    static GLuint Elided;
+
+    static void UseProgram(GLuint program);
+    // Bind a GL_TEXTURE_2D texture to the given texture unit
+    static void BindTexture(GLuint unit, GLuint texture);
+    static void BindVertexArray(GLuint vertexArray);
+    // Only GL_ARRAY_BUFFER is shadowed, other targets are passed through
+    static void BindBuffer(GLenum target, GLuint buffer);
+    static void BlendFunc(GLenum sfactor, GLenum dfactor);
+    static void BindFramebuffer(GLenum target, GLuint framebuffer);
+
+    // Delete objects and forget their bindings, so a recycled name isn't taken as still bound
+    static void DeleteProgram(GLuint program);
+    static void DeleteTextures(GLsizei count, const GLuint* textures);
+    static void DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+    static void DeleteBuffers(GLsizei count, const GLuint* buffers);
+
+    static void ResetCounters();
+    // Forget all shadowed state, e.g. after objects were deleted
+    static void Invalidate();
+
+private:
+    GLState() { }
+
+    static GLuint program;
+    static GLuint activeUnit;
+    static GLuint textures[GL_STATE_TEXTURE_UNITS];
+    static GLuint vertexArray;
+    static GLuint arrayBuffer;
+    static GLenum blendSrc, blendDst;
+    static GLuint readFramebuffer, drawFramebuffer;
+
+    static void activeTexture(GLuint unit);
+};
+
+#endif
@@ -0,0 +1,102 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+// Benchmark comparing level load times for a generated level: the
+// original getline/istringstream parser, the single pass text parser and
+// the mapped compiled file. The level files are written to the working
+// directory and removed afterwards.
+//   usage: level_bench.out [width] [height] [rounds]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "brick_field.h"
+#include "level_file.h"
+
+// Level loading as GameLevel::Load did it before the compiled format
+void LoadTextLevelOriginal(const GLchar* file, BrickField &bricks) {
+    GLuint tileCode;
+    std::string line;
+    std::ifstream fstream(file);
+    std::vector<std::vector<GLuint>> tileData;
+    while (std::getline(fstream, line)) {
+        std::istringstream sstream(line);
+        std::vector<GLuint> row;
+        while (sstream >> tileCode)
+            row.push_back(tileCode);
+        tileData.push_back(row);
+    }
+    GLuint width = tileData[0].size(), height = tileData.size();
+    std::vector<GLubyte> tiles(width*height, 0);
+    for (GLuint y = 0; y < height; ++y) {
+        for (GLuint x = 0; x < width && x < tileData[y].size(); ++x)
+            tiles[y*width + x] = tileData[y][x] > 255 ? 255 : tileData[y][x];
+    }
+    bricks.Init(tiles.data(), width, height, CountDestructible(tiles.data(), tiles.size()), 800, 300);
+}
+
+// Returns milliseconds per round
+template <typename Function>
+double Time(GLuint rounds, Function test) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (GLuint round = 0; round < rounds; ++round)
+        test();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count() / rounds;
+}
+
+int main(int argc, char* argv[]) {
+    GLuint width = argc > 1 ? std::atoi(argv[1]) : 2000;
+    GLuint height = argc > 2 ? std::atoi(argv[2]) : 2000;
+    GLuint rounds = argc > 3 ? std::atoi(argv[3]) : 5;
+    const GLchar* textFile = "level_bench.lvl";
+    const GLchar* binaryFile = "level_bench.blvl";
+
+    // mostly colored bricks with some gaps and solid blocks, like the shipped levels
+    std::vector<GLubyte> tiles(width*height);
+    std::ofstream text(textFile);
+    for (GLuint y = 0; y < height; ++y) {
+        for (GLuint x = 0; x < width; ++x) {
+            GLuint roll = rand() % 10;
+            tiles[y*width + x] = roll == 0 ? 0 : roll == 1 ? 1 : 2 + roll % 4;
+            text << GLuint(tiles[y*width + x]) << ' ';
+        }
+        text << '\n';
+    }
+    text.close();
+    WriteLevelFile(binaryFile, tiles, width, height);
+
+    std::cout << width << "x" << height << " level, " << rounds << " rounds" << std::endl;
+    BrickField original, parsed, mapped;
+    std::cout << "getline   " << Time(rounds, [&]() { LoadTextLevelOriginal(textFile, original); }) << " ms/load" << std::endl;
+    std::cout << "text      " << Time(rounds, [&]() {
+        std::vector<GLubyte> data;
+        GLuint w, h;
+        ReadTextLevel(textFile, data, w, h);
+        parsed.Init(data.data(), w, h, CountDestructible(data.data(), data.size()), 800, 300);
+    }) << " ms/load" << std::endl;
+    std::cout << "compiled  " << Time(rounds, [&]() {
+        LevelFile level;
+        level.Open(binaryFile);
+        mapped.Init(level.Tiles, level.Header->Width, level.Header->Height, level.Header->Destructible, 800, 300);
+    }) << " ms/load" << std::endl;
+
+    GLboolean same = original.Types == tiles && parsed.Types == tiles && mapped.Types == tiles
+        && original.Remaining == mapped.Remaining && parsed.Remaining == mapped.Remaining;
+    std::cout << (same ? "all loaders agree" : "MISMATCH between loaders") << std::endl;
+    std::remove(textFile);
+    std::remove(binaryFile);
+    return same ? 0 : 1;
+}
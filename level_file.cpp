@@ -0,0 +1,169 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "level_file.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+GLboolean ReadTextLevel(const GLchar* file, std::vector<GLubyte> &tiles, GLuint &width, GLuint &height) {
+    tiles.clear();
+    width = height = 0;
+    std::ifstream fstream(file, std::ios::binary);
+    if (!fstream) {
+        std::cout << "ERROR::LEVEL: Failed to read level file: " << file << std::endl;
+        return GL_FALSE;
+    }
+    // read the whole file at once and scan it in place
+    std::string text((std::istreambuf_iterator<char>(fstream)), std::istreambuf_iterator<char>());
+    const GLchar* cursor = text.c_str();
+    const GLchar* end = cursor + text.size();
+    while (cursor < end) {
+        const GLchar* lineEnd = static_cast<const GLchar*>(std::memchr(cursor, '\n', end - cursor));
+        if (!lineEnd)
+            lineEnd = end;
+        GLuint column = 0;
+        while (cursor < lineEnd) {
+            GLchar* next;
+            unsigned long code = std::strtoul(cursor, &next, 10);
+            // strtoul skips newlines too, don't let it run into the next row
+            if (next == cursor || next > lineEnd)
+                break;
+            cursor = next;
+            if (height == 0)
+                tiles.push_back(code > 255 ? 255 : code);
+            else if (column < width)
+                tiles[height*width + column] = code > 255 ? 255 : code;
+            ++column;
+        }
+        // blank lines ahead of the first row don't set the width, skip them
+        if (height == 0 && column == 0) {
+            cursor = lineEnd + 1;
+            continue;
+        }
+        if (height == 0)
+            width = column;
+        ++height;
+        // an empty row still counts, it leaves a gap in the level
+        tiles.resize((height + 1)*width, 0);
+        cursor = lineEnd + 1;
+    }
+    tiles.resize(height*width);
+    return GL_TRUE;
+}
+
+GLuint CountDestructible(const GLubyte* tiles, GLuint count) {
+    GLuint destructible = 0;
+    for (GLuint i = 0; i < count; ++i)
+        destructible += tiles[i] > 1;
+    return destructible;
+}
+
+GLboolean WriteLevelFile(const GLchar* file, const std::vector<GLubyte> &tiles, GLuint width, GLuint height, GLuint referenceWidth, GLuint referenceHeight) {
+    LevelFileHeader header;
+    std::memcpy(header.Magic, LEVEL_FILE_MAGIC, sizeof(header.Magic));
+    header.Version = LEVEL_FILE_VERSION;
+    header.Width = width;
+    header.Height = height;
+    header.Destructible = CountDestructible(tiles.data(), tiles.size());
+    header.ReferenceWidth = referenceWidth;
+    header.ReferenceHeight = referenceHeight;
+    header.TileOffset = sizeof(LevelFileHeader);
+    header.BrickOffset = (header.TileOffset + width*height + 3) & ~3u;
+
+    std::vector<LevelFileBrick> bricks;
+    GLfloat cellWidth = referenceWidth/static_cast<GLfloat>(width), cellHeight = referenceHeight/static_cast<GLfloat>(height);
+    for (GLuint cell = 0; cell < tiles.size(); ++cell) {
+        if (tiles[cell] == 0)
+            continue;
+        LevelFileBrick brick = {cell, (cell % width)*cellWidth, (cell / width)*cellHeight, cellWidth, cellHeight};
+        bricks.push_back(brick);
+    }
+    header.BrickCount = bricks.size();
+
+    std::ofstream fstream(file, std::ios::binary | std::ios::trunc);
+    if (!fstream) {
+        std::cout << "ERROR::LEVEL: Failed to write level file: " << file << std::endl;
+        return GL_FALSE;
+    }
+    const GLchar padding[4] = {0, 0, 0, 0};
+    fstream.write(reinterpret_cast<const GLchar*>(&header), sizeof(header));
+    fstream.write(reinterpret_cast<const GLchar*>(tiles.data()), tiles.size());
+    fstream.write(padding, header.BrickOffset - header.TileOffset - tiles.size());
+    fstream.write(reinterpret_cast<const GLchar*>(bricks.data()), bricks.size()*sizeof(LevelFileBrick));
+    return fstream.good();
+}
+
+GLboolean LevelFile::Open(const GLchar* file) {
+    this->Close();
+    GLint fd = open(file, O_RDONLY);
+    if (fd < 0) {
+        std::cout << "ERROR::LEVEL: Failed to read level file: " << file << std::endl;
+        return GL_FALSE;
+    }
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(LevelFileHeader)))
+        data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cout << "ERROR::LEVEL: Failed to map level file: " << file << std::endl;
+        return GL_FALSE;
+    }
+    this->data = data;
+    this->size = info.st_size;
+
+    const LevelFileHeader* header = static_cast<const LevelFileHeader*>(data);
+    // 64 bit sums so corrupt sizes can't wrap around
+    unsigned long long tileEnd = header->TileOffset + static_cast<unsigned long long>(header->Width)*header->Height;
+    unsigned long long brickEnd = header->BrickOffset + static_cast<unsigned long long>(header->BrickCount)*sizeof(LevelFileBrick);
+    if (std::memcmp(header->Magic, LEVEL_FILE_MAGIC, sizeof(header->Magic)) != 0 || header->Version != LEVEL_FILE_VERSION) {
+        std::cout << "ERROR::LEVEL: Not a version " << LEVEL_FILE_VERSION << " level file: " << file << std::endl;
+        this->Close();
+        return GL_FALSE;
+    }
+    if (header->TileOffset < sizeof(LevelFileHeader) || header->BrickOffset < sizeof(LevelFileHeader)) {
+        std::cout << "ERROR::LEVEL: Sections overlap the header of level file: " << file << std::endl;
+        this->Close();
+        return GL_FALSE;
+    }
+    if (tileEnd > this->size || brickEnd > this->size || header->BrickOffset % 4 != 0) {
+        std::cout << "ERROR::LEVEL: Truncated level file: " << file << std::endl;
+        this->Close();
+        return GL_FALSE;
+    }
+    // the game ends the level on this count, a stale one could never be reached or end it early
+    const GLubyte* tiles = static_cast<const GLubyte*>(data) + header->TileOffset;
+    if (CountDestructible(tiles, header->Width*header->Height) != header->Destructible) {
+        std::cout << "ERROR::LEVEL: Destructible count doesn't match the tiles: " << file << std::endl;
+        this->Close();
+        return GL_FALSE;
+    }
+    this->Header = header;
+    this->Tiles = tiles;
+    this->Bricks = reinterpret_cast<const LevelFileBrick*>(static_cast<const GLubyte*>(data) + header->BrickOffset);
+    return GL_TRUE;
+}
+
+void LevelFile::Close() {
+    if (this->data)
+        munmap(this->data, this->size);
+    this->data = nullptr;
+    this->size = 0;
+    this->Header = nullptr;
+    this->Tiles = nullptr;
+    this->Bricks = nullptr;
+}
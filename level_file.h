@@ -0,0 +1,81 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef LEVEL_FILE_H
+#define LEVEL_FILE_H
+#include <cstddef>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Compiled levels (.blvl), written by lvlc from the text .lvl files. The
+// layout is the header, Width*Height tile bytes (row major, padded to 4
+// bytes) and one rectangle per non empty tile, all little endian.
+const GLchar LEVEL_FILE_MAGIC[4] = {'B', 'L', 'V', 'L'};
+const GLuint LEVEL_FILE_VERSION = 1;
+// Area the brick rectangles are computed for, the upper half of the 800x600 screen
+const GLuint LEVEL_REFERENCE_WIDTH = 800;
+const GLuint LEVEL_REFERENCE_HEIGHT = 300;
+
+struct LevelFileHeader {
+    GLchar Magic[4];
+    GLuint Version;
+    // Grid size in cells
+    GLuint Width, Height;
+    // Tiles that are neither empty nor solid
+    GLuint Destructible;
+    // Area the rectangles were laid out in
+    GLuint ReferenceWidth, ReferenceHeight;
+    // Byte offsets from the start of the file
+    GLuint TileOffset;
+    GLuint BrickOffset, BrickCount;
+};
+
+// Bounds of a brick at the reference resolution
+struct LevelFileBrick {
+    GLuint Cell;
+    GLfloat X, Y, Width, Height;
+};
+
+
+// Parse a text level, every line is a row of whitespace separated tile
+// codes and the first row sets the width, blank lines before it are
+// skipped. Shorter rows are padded with empty tiles, longer ones cut,
+// codes above 255 are clamped.
+GLboolean ReadTextLevel(const GLchar* file, std::vector<GLubyte> &tiles, GLuint &width, GLuint &height);
+// Number of tiles that are neither empty nor solid
+GLuint CountDestructible(const GLubyte* tiles, GLuint count);
+// Compile a grid of tiles to a level file
+GLboolean WriteLevelFile(const GLchar* file, const std::vector<GLubyte> &tiles, GLuint width, GLuint height,
+    GLuint referenceWidth=LEVEL_REFERENCE_WIDTH, GLuint referenceHeight=LEVEL_REFERENCE_HEIGHT);
+
+
+// A compiled level mapped into memory, the pointers stay valid until
+// Close. Open checks the header, that every section lies inside the file
+// and that Destructible matches the tiles.
+class LevelFile {
+public:
+    const LevelFileHeader* Header;
+    const GLubyte* Tiles;
+    const LevelFileBrick* Bricks;
+
+    LevelFile() : Header(nullptr), Tiles(nullptr), Bricks(nullptr), data(nullptr), size(0) { }
+    ~LevelFile() { this->Close(); }
+
+    GLboolean Open(const GLchar* file);
+    void Close();
+
+private:
+    void* data;
+    size_t size;
+
+    LevelFile(const LevelFile&);
+    LevelFile& operator=(const LevelFile&);
+};
+
+#endif
@@ -0,0 +1,39 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+// Level compiler, turns a text level into the binary .blvl layout that
+// GameLevel::Load maps without parsing.
+//   usage: lvlc.out input.lvl output.blvl [reference width] [reference height]
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "level_file.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cout << "usage: " << argv[0] << " input.lvl output.blvl [reference width] [reference height]" << std::endl;
+        return 1;
+    }
+    GLuint referenceWidth = argc > 3 ? std::atoi(argv[3]) : LEVEL_REFERENCE_WIDTH;
+    GLuint referenceHeight = argc > 4 ? std::atoi(argv[4]) : LEVEL_REFERENCE_HEIGHT;
+
+    std::vector<GLubyte> tiles;
+    GLuint width, height;
+    if (!ReadTextLevel(argv[1], tiles, width, height))
+        return 1;
+    if (tiles.empty()) {
+        std::cout << "ERROR::LVLC: Level has no tiles: " << argv[1] << std::endl;
+        return 1;
+    }
+    if (!WriteLevelFile(argv[2], tiles, width, height, referenceWidth, referenceHeight))
+        return 1;
+    return 0;
+}
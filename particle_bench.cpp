@@ -0,0 +1,82 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+
+// Microbenchmark comparing the original array of structs particle update
+// against the structure of arrays kernels in particle_store.cpp.
+//   usage: particle_bench.out [particles] [frames]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "particle_store.h"
+
+// Particle layout and update loop as ParticleGenerator used them before the SoA store
+struct Particle {
+    glm::vec2 Position, Velocity;
+    glm::vec4 Color;
+    GLfloat Life;
+
+    Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) { }
+};
+
+void UpdateParticlesAoS(std::vector<Particle> &particles, GLfloat dt) {
+    for (GLuint i = 0; i < particles.size(); ++i) {
+        Particle &p = particles[i];
+        p.Life -= dt;
+        if (p.Life > 0.0f) {
+            p.Position -= p.Velocity * dt;
+            p.Color.a -= dt * 2.5;
+        }
+    }
+}
+
+// Returns milliseconds per frame
+template <typename Function>
+double Time(GLuint frames, Function update) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (GLuint frame = 0; frame < frames; ++frame)
+        update();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count() / frames;
+}
+
+int main(int argc, char* argv[]) {
+    GLuint count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    GLuint frames = argc > 2 ? std::atoi(argv[2]) : 200;
+    const GLfloat dt = 1.0f / 60.0f;
+
+    // Long lives so most particles stay alive for the whole run
+    std::vector<Particle> aos(count);
+    ParticleStore soa;
+    soa.Resize(count);
+    for (GLuint i = 0; i < count; ++i) {
+        GLfloat life = 1.0f + (rand() % 1000) / 10.0f;
+        GLfloat vx = (rand() % 100) - 50.0f, vy = (rand() % 100) - 50.0f;
+        aos[i].Life = soa.Life[i] = life;
+        aos[i].Velocity = glm::vec2(vx, vy);
+        soa.VelocityX[i] = vx;
+        soa.VelocityY[i] = vy;
+    }
+
+    std::cout << count << " particles, " << frames << " frames, " << ParticleKernelName(SelectParticleKernel()) << " selected" << std::endl;
+    std::cout << "aos     " << Time(frames, [&]() { UpdateParticlesAoS(aos, dt); }) << " ms/frame" << std::endl;
+
+    ParticleKernel kernels[] = { UpdateParticlesScalar, UpdateParticlesSSE, UpdateParticlesAVX };
+    for (ParticleKernel kernel : kernels) {
+        if (kernel == UpdateParticlesAVX && SelectParticleKernel() != UpdateParticlesAVX)
+            continue;
+        ParticleStore store = soa;
+        std::cout << ParticleKernelName(kernel) << "\t" << Time(frames, [&]() { kernel(store, 0, store.Size(), dt); }) << " ms/frame" << std::endl;
+    }
+    return 0;
+}
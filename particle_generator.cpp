@@ -7,54 +7,91 @@
 ** option) any later version.
 ******************************************************************/
 #include "particle_generator.h"
+#include "gl_state.h"
+
+#include <cstddef>
 
 ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, GLuint amount)
-    : shader(shader), texture(texture), amount(amount)
+    : RenderMode(PARTICLES_INSTANCED), shader(shader), texture(texture), amount(amount), alive(0), saturated(0), kernel(SelectParticleKernel())
 {
+    this->regionUniform = this->shader.GetUniform<glm::vec4>("region");
     this->init();
 }
 
-void ParticleGenerator::Update(GLfloat dt, GameObject &object, GLuint newParticles, glm::vec2 offset)
+void ParticleGenerator::Emit(glm::vec2 position, glm::vec2 velocity, GLuint newParticles, glm::vec2 offset)
 {
-    // Add new particles
+    // Add new particles to the end of the live range
     for (GLuint i = 0; i < newParticles; ++i)
     {
-        int unusedParticle = this->firstUnusedParticle();
-        this->respawnParticle(this->particles[unusedParticle], object, offset);
-    }
-    // Update all particles
-    for (GLuint i = 0; i < this->amount; ++i)
-    {
-        Particle &p = this->particles[i];
-        p.Life -= dt; // reduce life
-        if (p.Life > 0.0f)
-        {   // particle is alive, thus update
-            p.Position -= p.Velocity * dt;
-            p.Color.a -= dt * 2.5;
+        if (this->alive == this->amount)
+        {
+            // pool is full, if this keeps growing more particles should be reserved
+            this->saturated += newParticles - i;
+            break;
         }
+        this->respawnParticle(this->alive++, position, velocity, offset);
     }
 }
 
+void ParticleGenerator::Update(GLfloat dt)
+{
+    // Update live particles and drop the ones that died
+    this->kernel(this->particles, 0, this->alive, dt);
+    this->alive = CompactParticles(this->particles, this->alive);
+}
+
 // Render all particles
 void ParticleGenerator::Draw()
 {
     // Use additive blending to give it a 'glow' effect
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE);
     this->shader.Use();
-    for (Particle particle : this->particles)
+    this->regionUniform.Set(this->texture.Region);
+    this->texture.Bind();
+    if (this->RenderMode == PARTICLES_INSTANCED)
+        this->drawInstanced();
+    else
+        this->drawPerParticle();
+    // Don't forget to reset to default blending mode
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void ParticleGenerator::drawInstanced()
+{
+    // Pack live particles into the instance stream
+    const ParticleStore &p = this->particles;
+    this->instances.clear();
+    for (GLuint i = 0; i < this->alive; ++i)
     {
-        if (particle.Life > 0.0f)
-        {
-            this->shader.SetVector2f("offset", particle.Position);
-            this->shader.SetVector4f("color", particle.Color);
-            this->texture.Bind();
-            glBindVertexArray(this->VAO);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-            glBindVertexArray(0);
-        }
+        ParticleInstance instance = {
+            glm::vec2(p.PositionX[i], p.PositionY[i]),
+            glm::vec4(p.R[i], p.G[i], p.B[i], p.A[i])
+        };
+        this->instances.push_back(instance);
+    }
+    if (this->instances.empty())
+        return;
+    // Orphan last frame's storage instead of waiting for the GPU to finish with it
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, this->amount*sizeof(ParticleInstance), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, this->instances.size()*sizeof(ParticleInstance), &this->instances[0]);
+
+    GLState::BindVertexArray(this->instanceVAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, this->instances.size());
+}
+
+void ParticleGenerator::drawPerParticle()
+{
+    // offset and color have no arrays bound in this VAO, so the shader reads
+    // the current generic attribute values set here
+    const ParticleStore &p = this->particles;
+    GLState::BindVertexArray(this->VAO);
+    for (GLuint i = 0; i < this->alive; ++i)
+    {
+        glVertexAttrib2f(1, p.PositionX[i], p.PositionY[i]);
+        glVertexAttrib4f(2, p.R[i], p.G[i], p.B[i], p.A[i]);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
     }
-    // Don't forget to reset to default blending mode
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 void ParticleGenerator::init()
@@ -72,48 +109,47 @@ void ParticleGenerator::init()
     };
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &VBO);
-    glBindVertexArray(this->VAO);
+    GLState::BindVertexArray(this->VAO);
     // Fill mesh buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), particle_quad, GL_STATIC_DRAW);
     // Set mesh attributes
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (GLvoid*)0);
-    glBindVertexArray(0);
+    GLState::BindVertexArray(0);
 
-    // Create this->amount default particle instances
-    for (GLuint i = 0; i < this->amount; ++i)
-        this->particles.push_back(Particle());
-}
+    // Same mesh plus per instance offset and color for the instanced path
+    glGenVertexArrays(1, &this->instanceVAO);
+    glGenBuffers(1, &this->instanceVBO);
+    GLState::BindVertexArray(this->instanceVAO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (GLvoid*)0);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, this->amount*sizeof(ParticleInstance), NULL, GL_STREAM_DRAW);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (GLvoid*)offsetof(ParticleInstance, Offset));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (GLvoid*)offsetof(ParticleInstance, Color));
+    glVertexAttribDivisor(2, 1);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
+    this->instances.reserve(this->amount);
 
-// Stores the index of the last particle used (for quick access to next dead particle)
-GLuint lastUsedParticle = 0;
-GLuint ParticleGenerator::firstUnusedParticle()
-{
-    // First search from last used particle, this will usually return almost instantly
-    for (GLuint i = lastUsedParticle; i < this->amount; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
-        }
-    }
-    // Otherwise, do a linear search
-    for (GLuint i = 0; i < lastUsedParticle; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
-        }
-    }
-    // All particles are taken, override the first one (note that if it repeatedly hits this case, more particles should be reserved)
-    lastUsedParticle = 0;
-    return 0;
+    // Create this->amount default particle instances
+    this->particles.Resize(this->amount);
 }
 
-void ParticleGenerator::respawnParticle(Particle &particle, GameObject &object, glm::vec2 offset) {
+void ParticleGenerator::respawnParticle(GLuint index, glm::vec2 position, glm::vec2 velocity, glm::vec2 offset) {
     GLfloat random = ((rand() % 100) - 50) / 10.0f;
     GLfloat rColor = 0.5 + ((rand() % 100) / 100.0f);
-    particle.Position = object.Position + random + offset;
-    particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
-    particle.Life = 1.0f;
-    particle.Velocity = object.Velocity * 0.1f;
+    ParticleStore &p = this->particles;
+    p.PositionX[index] = position.x + random + offset.x;
+    p.PositionY[index] = position.y + random + offset.y;
+    p.R[index] = p.G[index] = p.B[index] = rColor;
+    p.A[index] = 1.0f;
+    p.Life[index] = 1.0f;
+    p.VelocityX[index] = velocity.x * 0.1f;
+    p.VelocityY[index] = velocity.y * 0.1f;
 }
@@ -17,16 +17,20 @@
 
 #include "shader.h"
 #include "texture.h"
-#include "game_object.h"
+#include "particle_store.h"
 
 
-// Represents a single particle and its state
-struct Particle {
-    glm::vec2 Position, Velocity;
+// Per particle data streamed to the GPU when rendering instanced
+struct ParticleInstance {
+    glm::vec2 Offset;
     glm::vec4 Color;
-    GLfloat Life;
+};
+
 
-    Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) { }
+// How ParticleGenerator::Draw submits particles
+enum ParticleRenderMode {
+    PARTICLES_INSTANCED,    // one instanced draw call for all live particles
+    PARTICLES_PER_PARTICLE  // one draw call per live particle (reference path)
 };
 
 
@@ -35,26 +39,41 @@ struct Particle {
 // them after a given amount of time.
 class ParticleGenerator {
 public:
+    // Render options
+    ParticleRenderMode RenderMode;
     // Constructor
     ParticleGenerator(Shader shader, Texture2D texture, GLuint amount);
-    // Update all particles
-    void Update(GLfloat dt, GameObject &object, GLuint newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    // Spawn particles at position + offset trailing an object moving with velocity
+    void Emit(glm::vec2 position, glm::vec2 velocity, GLuint newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    // Update all particles, including the ones emitted since the last update
+    void Update(GLfloat dt);
     // Render all particles
     void Draw();
+    // Telemetry for sizing the pool
+    GLuint AliveCount() const { return this->alive; }
+    GLuint SaturationCount() const { return this->saturated; }
 private:
-    // State
-    std::vector<Particle> particles;
+    // State, particles [0, alive) are live, the rest of the pool is dead
+    ParticleStore particles;
     GLuint amount;
+    GLuint alive;
+    // Spawns dropped because the pool was full
+    GLuint saturated;
+    ParticleKernel kernel;
     // Render state
     Shader shader;
+    UniformHandle<glm::vec4> regionUniform;
     Texture2D texture;
     GLuint VAO;
+    GLuint instanceVAO, instanceVBO;
+    std::vector<ParticleInstance> instances;
     // Initializes buffer and vertex attributes
     void init();
-    // Returns the first Particle index that's currently unused e.g. Life <= 0.0f or 0 if no particle is currently inactive
-    GLuint firstUnusedParticle();
+    // Draw paths for each render mode
+    void drawInstanced();
+    void drawPerParticle();
     // Respawns particle
-    void respawnParticle(Particle &particle, GameObject &object, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    void respawnParticle(GLuint index, glm::vec2 position, glm::vec2 velocity, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
 };
 
 #endif
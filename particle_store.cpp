@@ -0,0 +1,159 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "particle_store.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PARTICLE_STORE_X86
+#include <immintrin.h>
+#endif
+
+void ParticleStore::Resize(GLuint count) {
+    this->PositionX.resize(count, 0.0f);
+    this->PositionY.resize(count, 0.0f);
+    this->VelocityX.resize(count, 0.0f);
+    this->VelocityY.resize(count, 0.0f);
+    this->R.resize(count, 1.0f);
+    this->G.resize(count, 1.0f);
+    this->B.resize(count, 1.0f);
+    this->A.resize(count, 1.0f);
+    this->Life.resize(count, 0.0f);
+}
+
+void ParticleStore::Copy(GLuint from, GLuint to) {
+    this->PositionX[to] = this->PositionX[from];
+    this->PositionY[to] = this->PositionY[from];
+    this->VelocityX[to] = this->VelocityX[from];
+    this->VelocityY[to] = this->VelocityY[from];
+    this->R[to] = this->R[from];
+    this->G[to] = this->G[from];
+    this->B[to] = this->B[from];
+    this->A[to] = this->A[from];
+    this->Life[to] = this->Life[from];
+}
+
+GLuint CompactParticles(ParticleStore &store, GLuint count) {
+    for (GLuint i = 0; i < count; ) {
+        if (store.Life[i] > 0.0f) {
+            ++i;
+        } else {
+            // swap-remove, the moved particle is checked on the next pass of the loop
+            --count;
+            if (i != count)
+                store.Copy(count, i);
+            store.Life[count] = 0.0f;
+        }
+    }
+    return count;
+}
+
+void UpdateParticlesScalar(ParticleStore &store, GLuint begin, GLuint end, GLfloat dt) {
+    GLfloat fade = dt*PARTICLE_FADE_RATE;
+    for (GLuint i = begin; i < end; ++i) {
+        store.Life[i] -= dt; // reduce life
+        if (store.Life[i] > 0.0f) {
+            // particle is alive, thus update
+            store.PositionX[i] -= store.VelocityX[i]*dt;
+            store.PositionY[i] -= store.VelocityY[i]*dt;
+            store.A[i] -= fade;
+        }
+    }
+}
+
+#ifdef PARTICLE_STORE_X86
+
+__attribute__((target("sse2")))
+void UpdateParticlesSSE(ParticleStore &store, GLuint begin, GLuint end, GLfloat dt) {
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vfade = _mm_set1_ps(dt*PARTICLE_FADE_RATE);
+    const __m128 zero = _mm_setzero_ps();
+    GLfloat* life = store.Life.data();
+    GLfloat* px = store.PositionX.data();
+    GLfloat* py = store.PositionY.data();
+    const GLfloat* vx = store.VelocityX.data();
+    const GLfloat* vy = store.VelocityY.data();
+    GLfloat* a = store.A.data();
+
+    GLuint i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 l = _mm_sub_ps(_mm_loadu_ps(life + i), vdt);
+        _mm_storeu_ps(life + i, l);
+        // only live lanes move and fade, dead lanes keep their old values
+        __m128 alive = _mm_cmpgt_ps(l, zero);
+        __m128 dx = _mm_and_ps(alive, _mm_mul_ps(_mm_loadu_ps(vx + i), vdt));
+        __m128 dy = _mm_and_ps(alive, _mm_mul_ps(_mm_loadu_ps(vy + i), vdt));
+        __m128 da = _mm_and_ps(alive, vfade);
+        _mm_storeu_ps(px + i, _mm_sub_ps(_mm_loadu_ps(px + i), dx));
+        _mm_storeu_ps(py + i, _mm_sub_ps(_mm_loadu_ps(py + i), dy));
+        _mm_storeu_ps(a + i, _mm_sub_ps(_mm_loadu_ps(a + i), da));
+    }
+    UpdateParticlesScalar(store, i, end, dt);
+}
+
+__attribute__((target("avx")))
+void UpdateParticlesAVX(ParticleStore &store, GLuint begin, GLuint end, GLfloat dt) {
+    const __m256 vdt = _mm256_set1_ps(dt);
+    const __m256 vfade = _mm256_set1_ps(dt*PARTICLE_FADE_RATE);
+    const __m256 zero = _mm256_setzero_ps();
+    GLfloat* life = store.Life.data();
+    GLfloat* px = store.PositionX.data();
+    GLfloat* py = store.PositionY.data();
+    const GLfloat* vx = store.VelocityX.data();
+    const GLfloat* vy = store.VelocityY.data();
+    GLfloat* a = store.A.data();
+
+    GLuint i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 l = _mm256_sub_ps(_mm256_loadu_ps(life + i), vdt);
+        _mm256_storeu_ps(life + i, l);
+        __m256 alive = _mm256_cmp_ps(l, zero, _CMP_GT_OQ);
+        __m256 dx = _mm256_and_ps(alive, _mm256_mul_ps(_mm256_loadu_ps(vx + i), vdt));
+        __m256 dy = _mm256_and_ps(alive, _mm256_mul_ps(_mm256_loadu_ps(vy + i), vdt));
+        __m256 da = _mm256_and_ps(alive, vfade);
+        _mm256_storeu_ps(px + i, _mm256_sub_ps(_mm256_loadu_ps(px + i), dx));
+        _mm256_storeu_ps(py + i, _mm256_sub_ps(_mm256_loadu_ps(py + i), dy));
+        _mm256_storeu_ps(a + i, _mm256_sub_ps(_mm256_loadu_ps(a + i), da));
+    }
+    UpdateParticlesSSE(store, i, end, dt);
+}
+
+ParticleKernel SelectParticleKernel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx"))
+        return UpdateParticlesAVX;
+    if (__builtin_cpu_supports("sse2"))
+        return UpdateParticlesSSE;
+    return UpdateParticlesScalar;
+}
+
+#else
+
+// no SIMD paths on this architecture, fall back to the scalar loop
+void UpdateParticlesSSE(ParticleStore &store, GLuint begin, GLuint end, GLfloat dt) {
+    UpdateParticlesScalar(store, begin, end, dt);
+}
+
+void UpdateParticlesAVX(ParticleStore &store, GLuint begin, GLuint end, GLfloat dt) {
+    UpdateParticlesScalar(store, begin, end, dt);
+}
+
+ParticleKernel SelectParticleKernel() {
+    return UpdateParticlesScalar;
+}
+
+#endif
+
+const char* ParticleKernelName(ParticleKernel kernel) {
+#ifdef PARTICLE_STORE_X86
+    if (kernel == UpdateParticlesAVX)
+        return "avx";
+    if (kernel == UpdateParticlesSSE)
+        return "sse";
+#endif
+    return "scalar";
+}
@@ -0,0 +1,52 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef PARTICLE_STORE_H
+#define PARTICLE_STORE_H
+#include <vector>
+
+#include <glad/glad.h>
+
+// Rate at which a live particle fades out per second
+const GLfloat PARTICLE_FADE_RATE = 2.5f;
+
+
+// Particle state stored as structure of arrays, every attribute is
+// contiguous so the update kernels can process several particles per
+// instruction.
+struct ParticleStore {
+    std::vector<GLfloat> PositionX, PositionY;
+    std::vector<GLfloat> VelocityX, VelocityY;
+    std::vector<GLfloat> R, G, B, A;
+    std::vector<GLfloat> Life;
+
+    // Resize all attribute arrays, new particles start dead
+    void Resize(GLuint count);
+    // Overwrite particle to with particle from
+    void Copy(GLuint from, GLuint to);
+    GLuint Size() const { return this->Life.size(); }
+};
+
+
+// Ages particles [begin, end) by dt, moving and fading the ones still alive
+typedef void (*ParticleKernel)(ParticleStore &store, GLuint begin, GLuint end, GLfloat dt);
+
+void UpdateParticlesScalar(ParticleStore &store, GLuint begin, GLuint end, GLfloat dt);
+void UpdateParticlesSSE(ParticleStore &store, GLuint begin, GLuint end, GLfloat dt);
+void UpdateParticlesAVX(ParticleStore &store, GLuint begin, GLuint end, GLfloat dt);
+
+// Removes dead particles from the live prefix [0, count) by moving the
+// last live particle into their slot, returns the new live count
+GLuint CompactParticles(ParticleStore &store, GLuint count);
+
+// Returns the widest kernel this CPU supports
+ParticleKernel SelectParticleKernel();
+// Human readable name of a kernel, for logging and benchmarks
+const char* ParticleKernelName(ParticleKernel kernel);
+
+#endif
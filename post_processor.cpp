@@ -7,18 +7,19 @@
 ** option) any later version.
 ******************************************************************/
 #include "post_processor.h"
+#include "gl_state.h"
 
 #include <iostream>
 
 PostProcessor::PostProcessor(Shader shader, GLuint width, GLuint height)
-    : PostProcessingShader(shader), Texture(), Width(width), Height(height), Confuse(GL_FALSE), Chaos(GL_FALSE), Shake(GL_FALSE) {
+    : PostProcessingShader(shader), Texture(), Width(width), Height(height) {
     // Initialize renderbuffer/framebuffer object
     glGenFramebuffers(1, &this->MSFBO); // multisampled frame buffer object
     glGenFramebuffers(1, &this->FBO); // frame buffer object
     glGenRenderbuffers(1, &this->RBO); // multisampled color buffer
 
     // Initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
     glRenderbufferStorageMultisample(GL_RENDERBUFFER, 8, GL_RGB, width, height); // Allocate storage for render buffer object
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO); // Attach MS render buffer object to framebuffer
@@ -26,12 +27,12 @@ PostProcessor::PostProcessor(Shader shader, GLuint width, GLuint height)
         std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
 
     // Initialize the FBO/texture to blit multisampled color-buffer to; used for shader operations (for postprocessing effects)
-    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, this->FBO);
     this->Texture.Generate(width, height, NULL);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->Texture.ID, 0); // Attach texture to framebuffer as its color attachment
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Initialize render data and uniforms
     this->initRenderData();
@@ -50,7 +51,7 @@ PostProcessor::PostProcessor(Shader shader, GLuint width, GLuint height)
         {  0.0f,   -offset  },  // bottom-center
         {  offset, -offset  }   // bottom-right
     };
-    glUniform2fv(glGetUniformLocation(this->PostProcessingShader.ID, "offsets"), 9, (GLfloat*)offsets);
+    glUniform2fv(this->PostProcessingShader.GetUniformLocation("offsets"), 9, (GLfloat*)offsets);
 
     // initalize and load edge_kernel to the GPU
     GLint edge_kernel[9] = {
@@ -58,7 +59,7 @@ PostProcessor::PostProcessor(Shader shader, GLuint width, GLuint height)
         -1,  8, -1,
         -1, -1, -1
     };
-    glUniform1iv(glGetUniformLocation(this->PostProcessingShader.ID, "edge_kernel"), 9, edge_kernel);
+    glUniform1iv(this->PostProcessingShader.GetUniformLocation("edge_kernel"), 9, edge_kernel);
 
     // initalize and load blur_kernel to the GPU
     GLfloat blur_kernel[9] = {
@@ -66,37 +67,30 @@ PostProcessor::PostProcessor(Shader shader, GLuint width, GLuint height)
         2.0 / 16, 4.0 / 16, 2.0 / 16,
         1.0 / 16, 2.0 / 16, 1.0 / 16
     };
-    glUniform1fv(glGetUniformLocation(this->PostProcessingShader.ID, "blur_kernel"), 9, blur_kernel);    
+    glUniform1fv(this->PostProcessingShader.GetUniformLocation("blur_kernel"), 9, blur_kernel);    
 }
 
 void PostProcessor::BeginRender() {
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void PostProcessor::EndRender() {
     // Now resolve multisampled color-buffer into intermediate FBO to store to texture
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
+    GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
+    GLState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
     glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
     // Binds both READ and WRITE framebuffer to default framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void PostProcessor::Render(GLfloat time) {
-    // Set uniforms/options
+void PostProcessor::Render() {
     this->PostProcessingShader.Use();
-    this->PostProcessingShader.SetFloat("time", time);
-    this->PostProcessingShader.SetInteger("confuse", this->Confuse);
-    this->PostProcessingShader.SetInteger("chaos", this->Chaos);
-    this->PostProcessingShader.SetInteger("shake", this->Shake);
     // Render textured quad
-    glActiveTexture(GL_TEXTURE0);
     this->Texture.Bind();
-    glBindVertexArray(this->VAO);
+    GLState::BindVertexArray(this->VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
 }
 
 void PostProcessor::initRenderData() {
@@ -115,12 +109,12 @@ void PostProcessor::initRenderData() {
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &VBO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-    glBindVertexArray(this->VAO);
+    GLState::BindVertexArray(this->VAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4*sizeof(GL_FLOAT), (GLvoid*)0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
 }
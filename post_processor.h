@@ -16,21 +16,20 @@
 #include "sprite_renderer.h"
 #include "shader.h"
 
-// class for handeling the effect post processing
+// class for handeling the effect post processing, the effects to apply are
+// read by the shader from the FrameData block (see frame_uniforms.h)
 class PostProcessor {
 public:
     // State
     Shader PostProcessingShader;
     Texture2D Texture;
     GLuint Width, Height;
-    // Options
-    GLboolean Confuse, Chaos, Shake;
     // Constructor
     PostProcessor(Shader shader, GLuint width, GLuint height);
 
     void BeginRender();
     void EndRender();
-    void Render(GLfloat time);
+    void Render();
 
 private:
     // Render state
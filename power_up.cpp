@@ -0,0 +1,67 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "power_up.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+void PowerUpRegistry::RegisterEffect(std::string name, PowerUpHook activate, PowerUpHook deactivate) {
+    PowerUpEffect effect;
+    effect.Name = name;
+    effect.Activate = activate;
+    effect.Deactivate = deactivate;
+    this->Effects.push_back(effect);
+}
+
+GLboolean PowerUpRegistry::Load(const GLchar* file) {
+    std::ifstream fstream(file);
+    if (!fstream) {
+        std::cout << "ERROR::POWERUP: Failed to read power up file: " << file << std::endl;
+        return GL_FALSE;
+    }
+    std::vector<PowerUpType> types;
+    std::string line;
+    GLuint number = 0;
+    while (std::getline(fstream, line)) {
+        ++number;
+        // skip comments and empty lines
+        std::istringstream sstream(line.substr(0, line.find('#')));
+        PowerUpType type;
+        std::string effect, texture;
+        if (!(sstream >> type.Name))
+            continue;
+        if (!(sstream >> effect >> type.Chance >> type.Duration >> type.Color.r >> type.Color.g >> type.Color.b >> texture) || type.Chance == 0) {
+            std::cout << "ERROR::POWERUP: Malformed line " << number << " in " << file << std::endl;
+            return GL_FALSE;
+        }
+        type.Effect = this->Effects.size();
+        for (GLuint i = 0; i < this->Effects.size(); ++i) {
+            if (this->Effects[i].Name == effect)
+                type.Effect = i;
+        }
+        if (type.Effect == this->Effects.size()) {
+            std::cout << "ERROR::POWERUP: Unknown effect '" << effect << "' on line " << number << " in " << file << std::endl;
+            return GL_FALSE;
+        }
+        type.Sprite = GetSprite(texture);
+        type.Active = 0;
+        types.push_back(type);
+    }
+    this->Types = types;
+    return GL_TRUE;
+}
+
+GLint PowerUpRegistry::Find(const std::string &name) const {
+    for (GLuint i = 0; i < this->Types.size(); ++i) {
+        if (this->Types[i].Name == name)
+            return i;
+    }
+    return -1;
+}
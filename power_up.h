@@ -9,11 +9,13 @@
 #ifndef POWER_UP_H
 #define POWER_UP_H
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include "game_object.h"
+#include "entity_world.h"
 
 
 // The size of a PowerUp block
@@ -21,20 +23,47 @@ const glm::vec2 SIZE(60, 20);
 // Velocity a PowerUp block has when spawned
 const glm::vec2 VELOCITY(0.0f, 150.0f);
 
+// A power up falling towards the paddle and one whose effect is running,
+// picking one up moves it from the first archetype to the second
+const ComponentMask POWERUP_FALLING = COMPONENT_TRANSFORM | COMPONENT_VELOCITY | COMPONENT_SPRITE | COMPONENT_COLLIDER | COMPONENT_POWERUP;
+const ComponentMask POWERUP_ACTIVE = COMPONENT_LIFETIME | COMPONENT_POWERUP;
 
-// PowerUp inherits its state and rendering functions from
-// GameObject but also holds extra information to state its
-// active duration and whether it is activated or not.
-// The type of PowerUp is stored as a string.
-class PowerUp : public GameObject {
+class Game;
+// Applies or removes the effect of a power up
+typedef void (*PowerUpHook)(Game &game);
+
+// Code behind a power up, referenced by name from the data file
+struct PowerUpEffect {
+    std::string Name;
+    PowerUpHook Activate;
+    PowerUpHook Deactivate;   // may be null for instant effects
+};
+
+// A kind of power up as described by the data file
+struct PowerUpType {
+    std::string Name;
+    GLuint Effect;      // index into PowerUpRegistry::Effects
+    GLuint Chance;      // spawns for 1 in Chance destroyed bricks
+    GLfloat Duration;
+    glm::vec3 Color;
+    Texture2D Sprite;
+    // Number of power ups of this type currently activated
+    GLuint Active;
+};
+
+// Power up types loaded from a data file, a type is identified by its
+// index in Types.
+class PowerUpRegistry {
 public:
-    // PowerUp State
-    std::string Type;
-    GLfloat     Duration;
-    GLboolean   Activated;
-    // Constructor
-    PowerUp(std::string type, glm::vec3 color, GLfloat duration, glm::vec2 position, Texture2D texture) 
-        : GameObject(position, SIZE, texture, color, VELOCITY), Type(type), Duration(duration), Activated() { }
+    std::vector<PowerUpEffect> Effects;
+    std::vector<PowerUpType> Types;
+
+    // Effects have to be registered before loading a file that uses them
+    void RegisterEffect(std::string name, PowerUpHook activate, PowerUpHook deactivate=nullptr);
+    // Replace the types with the ones in file, returns false when the file can't be used
+    GLboolean Load(const GLchar* file);
+    // Index of the type called name, or -1
+    GLint Find(const std::string &name) const;
 };
 
 #endif
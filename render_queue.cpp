@@ -0,0 +1,131 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "render_queue.h"
+#include "gl_state.h"
+
+// bit positions of the key fields
+static const GLuint LAYER_SHIFT = 56;
+static const GLuint BLEND_SHIFT = 54;
+static const GLuint PROGRAM_SHIFT = 38;
+static const GLuint TEXTURE_SHIFT = 22;
+static const GLuint64 BLEND_MASK = 0x3;
+static const GLuint64 FIELD_MASK = 0xFFFF;
+static const GLuint64 DEPTH_MASK = 0x3FFFFF;
+
+GLuint64 MakeRenderKey(RenderLayer layer, BlendMode blend, GLuint program, GLuint texture, GLuint depth) {
+    return (static_cast<GLuint64>(layer & 0xFF) << LAYER_SHIFT)
+        | ((static_cast<GLuint64>(blend) & BLEND_MASK) << BLEND_SHIFT)
+        | ((program & FIELD_MASK) << PROGRAM_SHIFT)
+        | ((texture & FIELD_MASK) << TEXTURE_SHIFT)
+        | (depth & DEPTH_MASK);
+}
+
+static BlendMode keyBlend(GLuint64 key) {
+    return static_cast<BlendMode>((key >> BLEND_SHIFT) & BLEND_MASK);
+}
+
+RenderQueue::RenderQueue(SpriteBatch &batch)
+    : CommandCount(0), Batches(0), batch(&batch) { }
+
+void RenderQueue::Clear() {
+    this->commands.clear();
+    this->callbacks.clear();
+    this->entries.clear();
+}
+
+void RenderQueue::DrawSprite(RenderLayer layer, const Texture2D &texture, glm::vec2 position, glm::vec2 size, GLfloat rotate, glm::vec3 color, GLuint depth) {
+    RenderCommand command;
+    command.TextureID = texture.ID;
+    command.Region = texture.Region;
+    command.Position = position;
+    command.Size = size;
+    command.Rotation = rotate;
+    command.Color = color;
+    command.Callback = RENDER_NO_CALLBACK;
+    SortEntry entry = {MakeRenderKey(layer, BLEND_ALPHA, this->batch->ProgramID(), texture.ID, depth), (GLuint)this->commands.size()};
+    this->entries.push_back(entry);
+    this->commands.push_back(command);
+}
+
+void RenderQueue::DrawCustom(RenderLayer layer, BlendMode blend, GLuint program, GLuint texture, std::function<void()> draw, GLuint depth) {
+    RenderCommand command;
+    command.Callback = this->callbacks.size();
+    this->callbacks.push_back(draw);
+    SortEntry entry = {MakeRenderKey(layer, blend, program, texture, depth), (GLuint)this->commands.size()};
+    this->entries.push_back(entry);
+    this->commands.push_back(command);
+}
+
+void RenderQueue::Submit() {
+    this->sort();
+    this->CommandCount = this->entries.size();
+    this->Batches = 0;
+
+    GLboolean batching = GL_FALSE;
+    BlendMode blend = BLEND_ALPHA;
+    for (const SortEntry &entry : this->entries) {
+        const RenderCommand &command = this->commands[entry.Command];
+        GLboolean custom = command.Callback != RENDER_NO_CALLBACK;
+        BlendMode commandBlend = keyBlend(entry.Key);
+        // anything but another sprite with the same blend mode ends the batch
+        if (batching && (custom || commandBlend != blend)) {
+            this->batch->Flush();
+            batching = GL_FALSE;
+        }
+        blend = commandBlend;
+        if (custom) {
+            this->setBlend(blend);
+            this->callbacks[command.Callback]();
+            continue;
+        }
+        if (!batching) {
+            this->setBlend(blend);
+            this->batch->Begin();
+            batching = GL_TRUE;
+            ++this->Batches;
+        }
+        this->batch->Submit(command.TextureID, command.Region, command.Position, command.Size, command.Rotation, command.Color);
+    }
+    if (batching)
+        this->batch->Flush();
+    // custom draws may have changed the blend function
+    this->setBlend(BLEND_ALPHA);
+    this->Clear();
+}
+
+void RenderQueue::sort() {
+    // least significant digit radix sort, one byte per pass. The sort is
+    // stable so commands with equal keys stay in recording order
+    GLuint count = this->entries.size();
+    this->scratch.resize(count);
+    for (GLuint shift = 0; shift < 64; shift += 8) {
+        GLuint offsets[256] = {0};
+        for (GLuint i = 0; i < count; ++i)
+            ++offsets[(this->entries[i].Key >> shift) & 0xFF];
+        // skip the pass when every key has the same byte here
+        if (count == 0 || offsets[(this->entries[0].Key >> shift) & 0xFF] == count)
+            continue;
+        GLuint total = 0;
+        for (GLuint i = 0; i < 256; ++i) {
+            GLuint n = offsets[i];
+            offsets[i] = total;
+            total += n;
+        }
+        for (GLuint i = 0; i < count; ++i)
+            this->scratch[offsets[(this->entries[i].Key >> shift) & 0xFF]++] = this->entries[i];
+        this->entries.swap(this->scratch);
+    }
+}
+
+void RenderQueue::setBlend(BlendMode blend) {
+    if (blend == BLEND_ADDITIVE)
+        GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE);
+    else
+        GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
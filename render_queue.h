@@ -0,0 +1,92 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <vector>
+#include <functional>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "texture.h"
+#include "sprite_batch.h"
+
+// Draw order of the scene, lower layers are drawn first
+enum RenderLayer {
+    LAYER_BACKGROUND,
+    LAYER_PARTICLES,
+    LAYER_OBJECTS
+};
+
+enum BlendMode {
+    BLEND_ALPHA,    // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+    BLEND_ADDITIVE  // GL_SRC_ALPHA, GL_ONE
+};
+
+// Sort key layout, most significant bits first:
+// | layer 8 | blend 2 | program 16 | texture 16 | depth 22 |
+// commands with equal keys keep the order they were recorded in
+GLuint64 MakeRenderKey(RenderLayer layer, BlendMode blend, GLuint program, GLuint texture, GLuint depth=0);
+
+// A recorded draw, either a sprite drawn through the SpriteBatch or a
+// callback for renderers that issue their own draw calls. Plain data, so
+// recording a command allocates nothing once the queue has grown.
+struct RenderCommand {
+    // texture object and the part of it the sprite shows <u0, v0, u1, v1>
+    GLuint TextureID;
+    glm::vec4 Region;
+    glm::vec2 Position;
+    glm::vec2 Size;
+    GLfloat Rotation;
+    glm::vec3 Color;
+    // index into the callbacks of the queue, RENDER_NO_CALLBACK for sprites
+    GLuint Callback;
+};
+
+const GLuint RENDER_NO_CALLBACK = ~0u;
+
+// RenderQueue records the draws of a frame, sorts them by key and then
+// replays them. Sprites that end up next to each other share batches, the
+// order of layers is set by the key instead of the order of the calls.
+class RenderQueue {
+public:
+    // Statistics of the last Submit
+    GLuint CommandCount;
+    GLuint Batches;
+
+    // Constructor, sprites are drawn with batch
+    RenderQueue(SpriteBatch &batch);
+
+    // Remove all recorded commands
+    void Clear();
+    // Record a sprite
+    void DrawSprite(RenderLayer layer, const Texture2D &texture, glm::vec2 position, glm::vec2 size=glm::vec2(10, 10), GLfloat rotate=0.0f, glm::vec3 color=glm::vec3(1.0f), GLuint depth=0);
+    // Record a draw issued by draw, program and texture are only used for sorting
+    void DrawCustom(RenderLayer layer, BlendMode blend, GLuint program, GLuint texture, std::function<void()> draw, GLuint depth=0);
+    // Sort the recorded commands and replay them, the queue is empty afterwards
+    void Submit();
+
+private:
+    struct SortEntry {
+        GLuint64 Key;
+        GLuint Command;
+    };
+
+    SpriteBatch *batch;
+    std::vector<RenderCommand> commands;
+    std::vector<std::function<void()>> callbacks;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;
+
+    void sort();
+    void setBlend(BlendMode blend);
+};
+
+#endif
@@ -0,0 +1,36 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef RESOURCE_ID_H
+#define RESOURCE_ID_H
+
+#include <string>
+
+#include <glad/glad.h>
+
+// 32 bit FNV-1a hash of a name, usable in constant expressions
+constexpr GLuint HashName(const GLchar* name, GLuint hash=2166136261u) {
+    return *name == '\0' ? hash : HashName(name + 1, (hash ^ static_cast<unsigned char>(*name))*16777619u);
+}
+
+// Interned name of a resource. Resources are keyed by the hash alone, a
+// constexpr ResourceID built from a literal costs nothing at runtime.
+// ResourceManager reports two names with the same hash when they are added
+// and only stores the first one.
+struct ResourceID {
+    GLuint Hash;
+    // for error messages only, not owned and not valid past the call taking the ID
+    const GLchar* Name;
+
+    constexpr ResourceID(const GLchar* name) : Hash(HashName(name)), Name(name) { }
+    ResourceID(const std::string &name) : Hash(HashName(name.c_str())), Name(name.c_str()) { }
+    // an ID hashed before, for callers keeping a copy of the name
+    constexpr ResourceID(GLuint hash, const GLchar* name) : Hash(hash), Name(name) { }
+};
+
+#endif
@@ -14,46 +14,114 @@
 
 #include <stb_image/stb_image.h>
 
-std::map<std::string, Shader> ResourceManager::Shaders;
-std::map<std::string, Texture2D> ResourceManager::Textures;
+#include "frame_uniforms.h"
+#include "gl_state.h"
+
+// slot 0 of each table is the empty resource
+std::vector<Shader> ResourceManager::Shaders(1);
+std::vector<Texture2D> ResourceManager::Textures(1);
+TextureAtlas ResourceManager::Atlas;
+std::unordered_map<GLuint, GLuint> ResourceManager::shaderSlots;
+std::unordered_map<GLuint, GLuint> ResourceManager::textureSlots;
+std::unordered_map<GLuint, std::string> ResourceManager::names;
+
+ShaderHandle ResourceManager::LoadShader(const GLchar* vShaderFile, const GLchar* fShaderFile, const GLchar* gShaderFile, ResourceID name) {
+    return addShader(name, loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile));
+}
 
-Shader ResourceManager::LoadShader(const GLchar* vShaderFile, const GLchar* fShaderFile, const GLchar* gShaderFile, std::string name) {
-    Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-    return Shaders[name];
+ShaderHandle ResourceManager::FindShader(ResourceID name) {
+    auto iter = shaderSlots.find(name.Hash);
+    if (iter == shaderSlots.end()) {
+        std::cout << "ERROR::RESOURCE: Unknown shader: " << name.Name << std::endl;
+        return ShaderHandle();
+    }
+    return ShaderHandle(iter->second);
 }
 
-Shader ResourceManager::GetShader(std::string name) {
-    return Shaders[name];
+TextureHandle ResourceManager::LoadTexture(const GLchar* file, ResourceID name) {
+    return addTexture(name, loadTextureFromFile(file));
+}
+
+TextureHandle ResourceManager::FindTexture(ResourceID name) {
+    auto iter = textureSlots.find(name.Hash);
+    if (iter == textureSlots.end()) {
+        std::cout << "ERROR::RESOURCE: Unknown texture: " << name.Name << std::endl;
+        return TextureHandle();
+    }
+    return TextureHandle(iter->second);
 }
 
-Texture2D ResourceManager::LoadTexture(const GLchar* file, std::string name) {
-    Textures[name] = loadTextureFromFile(file);
-    return Textures[name];
+void ResourceManager::LoadAtlasTexture(const GLchar* file, std::string name) {
+    // atlas pages are always RGBA
+    int width, height, numChannels;
+    unsigned char* image = stbi_load(file, &width, &height, &numChannels, 4);
+    if (image) {
+        Atlas.Add(name, width, height, image);
+    } else {
+        std::cout << "ERROR::TEXTURE: Failed to read texture file: " << file << std::endl;
+    }
+    stbi_image_free(image);
 }
 
-Texture2D ResourceManager::GetTexture(std::string name) {
-    return Textures[name];
+void ResourceManager::BuildAtlas() {
+    std::map<std::string, Texture2D> regions = Atlas.Build();
+    for (auto iter : regions)
+        addTexture(iter.first, iter.second);
 }
 
 void ResourceManager::Clear() {
-    // free assets
-    for (auto iter : Shaders)
-        glDeleteProgram(iter.second.ID);
-    for (auto iter : Textures)
-        glDeleteTextures(1, &iter.second.ID);
+    // free assets, regions of the same atlas page share an ID but deleting
+    // an already deleted texture name is silently ignored by OpenGL
+    for (const Shader &shader : Shaders)
+        GLState::DeleteProgram(shader.ID);
+    for (const Texture2D &texture : Textures)
+        GLState::DeleteTextures(1, &texture.ID);
+    Shaders.resize(1);
+    Textures.resize(1);
+    shaderSlots.clear();
+    textureSlots.clear();
+    names.clear();
+    GLState::Invalidate();
+}
+
+ShaderHandle ResourceManager::addShader(ResourceID name, const Shader &shader) {
+    return ShaderHandle(store(shaderSlots, Shaders, name, shader));
+}
+
+TextureHandle ResourceManager::addTexture(ResourceID name, const Texture2D &texture) {
+    return TextureHandle(store(textureSlots, Textures, name, texture));
+}
+
+template <typename T>
+GLuint ResourceManager::store(std::unordered_map<GLuint, GLuint> &slots, std::vector<T> &table, ResourceID name, const T &resource) {
+    // a colliding name gets the empty resource, the name registered first keeps its slot
+    auto known = names.insert(std::make_pair(name.Hash, std::string(name.Name)));
+    if (!known.second && known.first->second != name.Name) {
+        std::cout << "ERROR::RESOURCE: Names " << known.first->second << " and " << name.Name << " have the same hash, " << name.Name << " is not stored" << std::endl;
+        return 0;
+    }
+    auto slot = slots.insert(std::make_pair(name.Hash, static_cast<GLuint>(table.size())));
+    if (slot.second)
+        table.push_back(resource);
+    else
+        table[slot.first->second] = resource;
+    return slot.first->second;
 }
 
 Shader ResourceManager::loadShaderFromFile(const GLchar* vShaderFile, const GLchar* fShaderFile, const GLchar* gShaderFile) {
-    std::string vShaderCode = loadSourceCode(vShaderFile).c_str();
-    std::string fShaderCode = loadSourceCode(fShaderFile).c_str();
+    std::string vShaderCode = loadSourceCode(vShaderFile);
+    std::string fShaderCode = loadSourceCode(fShaderFile);
     std::string gShaderCode = "";
-    if (gShaderFile != nullptr) {
-        std::string gShaderCode = loadSourceCode(gShaderFile).c_str();
-    }
+    if (gShaderFile != nullptr)
+        gShaderCode = loadSourceCode(gShaderFile);
+    return compileShader(vShaderCode, fShaderCode, gShaderCode);
+}
 
+Shader ResourceManager::compileShader(const std::string &vShaderCode, const std::string &fShaderCode, const std::string &gShaderCode) {
     // compile and link shader code
     Shader shader;
-    shader.Compile(vShaderCode.c_str(), fShaderCode.c_str(), (gShaderFile != nullptr) ? gShaderCode.c_str() : nullptr);
+    shader.Compile(vShaderCode.c_str(), fShaderCode.c_str(), gShaderCode.empty() ? nullptr : gShaderCode.c_str());
+    shader.BindUniformBlock(FRAME_UNIFORM_BLOCK, FRAME_UNIFORM_BINDING);
     return shader;
 }
 
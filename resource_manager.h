@@ -9,35 +9,76 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
-#include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <glad/glad.h>
 
 #include "texture.h"
 #include "shader.h"
+#include "texture_atlas.h"
+#include "resource_id.h"
+
+// Slots in the tables of ResourceManager, resolve names once with Find and
+// keep the handle. Index 0 is an empty resource that unknown names map to.
+struct ShaderHandle {
+    GLuint Index;
+    explicit ShaderHandle(GLuint index=0) : Index(index) { }
+};
+
+struct TextureHandle {
+    GLuint Index;
+    explicit TextureHandle(GLuint index=0) : Index(index) { }
+};
 
 // static singleton resource manager class
 class ResourceManager {
 public:
-    // asset storage
-    static std::map<std::string, Shader> Shaders;
-    static std::map<std::string, Texture2D> Textures;
+    // asset storage, dense tables indexed by handle
+    static std::vector<Shader> Shaders;
+    static std::vector<Texture2D> Textures;
+    static TextureAtlas Atlas;
 
-    // setup shader
-    static Shader LoadShader(const GLchar* vShaderFile, const GLchar* fShaderFile, const GLchar* gShaderFile, std::string name);
-    static Shader GetShader(std::string name);
+    // setup shader, loading a name again replaces the shader in its slot
+    static ShaderHandle LoadShader(const GLchar* vShaderFile, const GLchar* fShaderFile, const GLchar* gShaderFile, ResourceID name);
+    // unknown names are reported and give the empty shader
+    static ShaderHandle FindShader(ResourceID name);
+    static Shader &GetShader(ShaderHandle handle) { return Shaders[handle.Index]; }
 
-    // setup texture
-    static Texture2D LoadTexture(const GLchar* file, std::string name);
-    static Texture2D GetTexture(std::string name);
+    // setup texture, loading a name again replaces the texture in its slot
+    static TextureHandle LoadTexture(const GLchar* file, ResourceID name);
+    // unknown names are reported and give the empty texture
+    static TextureHandle FindTexture(ResourceID name);
+    static const Texture2D &GetTexture(TextureHandle handle) { return Textures[handle.Index]; }
+
+    // setup atlas, queued textures become regions of the atlas pages once it is built
+    static void LoadAtlasTexture(const GLchar* file, std::string name);
+    static void BuildAtlas();
 
     // cleanup assets
     static void Clear();
 
 private:
+    // the asset loader reads sources on its workers and finishes them here on the GL thread
+    friend class AssetLoader;
+
+    // slot of every name hash in Shaders and Textures
+    static std::unordered_map<GLuint, GLuint> shaderSlots;
+    static std::unordered_map<GLuint, GLuint> textureSlots;
+    // name behind every hash, to report collisions
+    static std::unordered_map<GLuint, std::string> names;
+
     ResourceManager() { }
+    static ShaderHandle addShader(ResourceID name, const Shader &shader);
+    static TextureHandle addTexture(ResourceID name, const Texture2D &texture);
+    // slot for name in a table, appended when the name is new. A name whose hash
+    // is taken by another name is reported and gets slot 0.
+    template <typename T>
+    static GLuint store(std::unordered_map<GLuint, GLuint> &slots, std::vector<T> &table, ResourceID name, const T &resource);
     static Shader loadShaderFromFile(const GLchar* vShaderFile, const GLchar* fShaderFile, const GLchar* gShaderFile=nullptr);
+    // compile and link a program, an empty geometry source means there is no geometry stage
+    static Shader compileShader(const std::string &vShaderCode, const std::string &fShaderCode, const std::string &gShaderCode);
     static std::string loadSourceCode(const GLchar* sourcePath);
     static Texture2D loadTextureFromFile(const GLchar* file);
 };
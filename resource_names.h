@@ -0,0 +1,37 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef RESOURCE_NAMES_H
+#define RESOURCE_NAMES_H
+
+#include "resource_id.h"
+
+// Names of the resources the game loads. Being constexpr they are hashed
+// by the compiler, pass these instead of literals so no build hashes the
+// names at runtime. Power ups are looked up by the names in their data
+// file, which have to match the ones here.
+constexpr ResourceID SHADER_SPRITE_BATCH("sprite_batch");
+constexpr ResourceID SHADER_PARTICLE("particle");
+constexpr ResourceID SHADER_POST_PROCESSING("postprocessing");
+constexpr ResourceID SHADER_TEXT("text");
+constexpr ResourceID SHADER_TEXT_SDF("text_sdf");
+
+constexpr ResourceID TEXTURE_BACKGROUND("background");
+constexpr ResourceID TEXTURE_FACE("face");
+constexpr ResourceID TEXTURE_PADDLE("paddle");
+constexpr ResourceID TEXTURE_BLOCK("block");
+constexpr ResourceID TEXTURE_BLOCK_SOLID("block_solid");
+constexpr ResourceID TEXTURE_PARTICLE("particle");
+constexpr ResourceID TEXTURE_POWERUP_SPEED("powerup_speed");
+constexpr ResourceID TEXTURE_POWERUP_STICKY("powerup_sticky");
+constexpr ResourceID TEXTURE_POWERUP_INCREASE("powerup_increase");
+constexpr ResourceID TEXTURE_POWERUP_CONFUSE("powerup_confuse");
+constexpr ResourceID TEXTURE_POWERUP_CHAOS("powerup_chaos");
+constexpr ResourceID TEXTURE_POWERUP_PASSTHROUGH("powerup_passthrough");
+
+#endif
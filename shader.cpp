@@ -7,11 +7,20 @@
 ** option) any later version.
 ******************************************************************/
 #include "shader.h"
+#include "gl_state.h"
+#include "resource_id.h"
 
 #include <iostream>
+#include <set>
+#include <utility>
+
+namespace {
+    // missing uniforms already reported, per program
+    std::set<std::pair<GLuint, std::string>> reportedUniforms;
+}
 
 Shader &Shader::Use() {
-    glUseProgram(this->ID);
+    GLState::UseProgram(this->ID);
     return *this;
 }
 
@@ -46,6 +55,7 @@ void Shader::Compile(const GLchar* vertexSource, const GLchar* fragmentSource, c
         glAttachShader(this->ID, sGeometry);
     glLinkProgram(this->ID);
     checkCompileErrors(this->ID, "PROGRAM");
+    this->reflectUniforms();
 
     // cleanup linked shaders
     glDeleteShader(sVertex);
@@ -57,55 +67,125 @@ void Shader::Compile(const GLchar* vertexSource, const GLchar* fragmentSource, c
 void Shader::SetFloat(const GLchar* name, GLfloat value, GLboolean useShader) {
     if (useShader)
         this->Use();
-    glUniform1f(glGetUniformLocation(this->ID, name), value);
+    glUniform1f(this->GetUniformLocation(name), value);
 }
 
 void Shader::SetInteger(const GLchar* name, GLint value, GLboolean useShader) {
     if (useShader)
         this->Use();
-    glUniform1i(glGetUniformLocation(this->ID, name), value);
+    glUniform1i(this->GetUniformLocation(name), value);
 }
 
 void Shader::SetVector2f(const GLchar* name, GLfloat x, GLfloat y, GLboolean useShader) {
     if (useShader)
         this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), x, y);
+    glUniform2f(this->GetUniformLocation(name), x, y);
 }
 
 void Shader::SetVector2f(const GLchar* name, const glm::vec2 &value, GLboolean useShader) {
     if (useShader)
         this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), value.x, value.y);
+    glUniform2f(this->GetUniformLocation(name), value.x, value.y);
 }
 
 void Shader::SetVector3f(const GLchar* name, GLfloat x, GLfloat y, GLfloat z, GLboolean useShader) {
     if (useShader)
         this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), x, y, z);
+    glUniform3f(this->GetUniformLocation(name), x, y, z);
 }
 
 void Shader::SetVector3f(const GLchar* name, const glm::vec3 &value, GLboolean useShader) {
     if (useShader)
         this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z);
+    glUniform3f(this->GetUniformLocation(name), value.x, value.y, value.z);
 }
 
 void Shader::SetVector4f(const GLchar* name, GLfloat x, GLfloat y, GLfloat z, GLfloat w, GLboolean useShader) {
     if (useShader)
         this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), x, y, z, w);
+    glUniform4f(this->GetUniformLocation(name), x, y, z, w);
 }
 
 void Shader::SetVector4f(const GLchar* name, const glm::vec4 &value, GLboolean useShader) {
     if (useShader)
         this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z, value.w);
+    glUniform4f(this->GetUniformLocation(name), value.x, value.y, value.z, value.w);
 }
 
 void Shader::SetMatrix4(const GLchar* name, const glm::mat4 &matrix, GLboolean useShader) {
     if (useShader)
         this->Use();
-    glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, GL_FALSE, glm::value_ptr(matrix));
+    glUniformMatrix4fv(this->GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
+}
+
+void Shader::BindUniformBlock(const GLchar* name, GLuint binding) {
+    GLuint index = glGetUniformBlockIndex(this->ID, name);
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(this->ID, index, binding);
+}
+
+GLint Shader::GetUniformLocation(const GLchar* name) const {
+    if (!this->uniforms.empty()) {
+        GLuint hash = HashName(name);
+        GLuint mask = this->uniforms.size() - 1;
+        for (GLuint i = hash & mask; !this->uniforms[i].Name.empty(); i = (i + 1) & mask) {
+            if (this->uniforms[i].Hash == hash && this->uniforms[i].Name == name)
+                return this->uniforms[i].Location;
+        }
+    }
+    if (reportedUniforms.insert(std::make_pair(this->ID, std::string(name))).second)
+        std::cout << "| WARNING::SHADER: Unknown uniform '" << name << "' in program " << this->ID << std::endl;
+    return -1;
+}
+
+void Shader::reflectUniforms() {
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    // gather names first, arrays contribute their base name and every element
+    std::vector<std::pair<std::string, GLint>> found;
+    std::vector<GLchar> buffer(maxLength + 1);
+    for (GLint i = 0; i < count; ++i) {
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(this->ID, i, buffer.size(), NULL, &size, &type, &buffer[0]);
+        std::string name(&buffer[0]);
+        GLint location = glGetUniformLocation(this->ID, name.c_str());
+        if (location < 0)
+            continue; // uniform block member
+
+        std::string::size_type bracket = name.find('[');
+        if (bracket == std::string::npos) {
+            found.push_back(std::make_pair(name, location));
+            continue;
+        }
+        std::string base = name.substr(0, bracket);
+        found.push_back(std::make_pair(base, location));
+        for (GLint element = 0; element < size; ++element) {
+            std::string elementName = base + "[" + std::to_string(element) + "]";
+            found.push_back(std::make_pair(elementName, glGetUniformLocation(this->ID, elementName.c_str())));
+        }
+    }
+
+    // keep the table at most half full so probe chains stay short
+    GLuint capacity = 8;
+    while (capacity < 2*found.size())
+        capacity *= 2;
+    this->uniforms.assign(capacity, Uniform());
+    for (auto &uniform : found)
+        this->insertUniform(uniform.first, uniform.second);
+}
+
+void Shader::insertUniform(const std::string &name, GLint location) {
+    GLuint mask = this->uniforms.size() - 1;
+    GLuint hash = HashName(name.c_str());
+    GLuint i = hash & mask;
+    while (!this->uniforms[i].Name.empty() && this->uniforms[i].Name != name)
+        i = (i + 1) & mask;
+    this->uniforms[i].Name = name;
+    this->uniforms[i].Hash = hash;
+    this->uniforms[i].Location = location;
 }
 
 void Shader::checkCompileErrors(GLuint object, std::string type) {
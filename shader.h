@@ -10,11 +10,31 @@
 #define SHADER_H
 
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+// Uniform location resolved once, setting it needs no string lookups
+template <typename T>
+class UniformHandle {
+public:
+    GLint Location;
+
+    UniformHandle(GLint location=-1) : Location(location) { }
+
+    // data transfer (glUniform), the owning shader must be in use
+    void Set(const T &value) const;
+};
+
+template <> inline void UniformHandle<GLfloat>::Set(const GLfloat &value) const { glUniform1f(this->Location, value); }
+template <> inline void UniformHandle<GLint>::Set(const GLint &value) const { glUniform1i(this->Location, value); }
+template <> inline void UniformHandle<glm::vec2>::Set(const glm::vec2 &value) const { glUniform2f(this->Location, value.x, value.y); }
+template <> inline void UniformHandle<glm::vec3>::Set(const glm::vec3 &value) const { glUniform3f(this->Location, value.x, value.y, value.z); }
+template <> inline void UniformHandle<glm::vec4>::Set(const glm::vec4 &value) const { glUniform4f(this->Location, value.x, value.y, value.z, value.w); }
+template <> inline void UniformHandle<glm::mat4>::Set(const glm::mat4 &value) const { glUniformMatrix4fv(this->Location, 1, GL_FALSE, glm::value_ptr(value)); }
+
 // Arbitray shader class
 class Shader {
 public:
@@ -22,7 +42,7 @@ public:
     GLuint ID;
 
     // Constructor
-    Shader() { }
+    Shader() : ID(0) { }
 
     // Sets the current shader as active
     Shader &Use();
@@ -41,10 +61,31 @@ public:
     void SetVector4f(const GLchar* name, const glm::vec4 &value, GLboolean useShader=false);
     void SetMatrix4(const GLchar* name, const glm::mat4 &matrix, GLboolean useShader=false);
 
+    // Attach the named uniform block to a buffer binding point, if the program uses it
+    void BindUniformBlock(const GLchar* name, GLuint binding);
+
+    // uniform lookup in the table reflected after linking, unknown names
+    // are reported once and return -1
+    GLint GetUniformLocation(const GLchar* name) const;
+    template <typename T>
+    UniformHandle<T> GetUniform(const GLchar* name) const { return UniformHandle<T>(this->GetUniformLocation(name)); }
+
 private:
     // private variables
     static const unsigned int infoLogLen = 1024;
 
+    // open addressing hash table of active uniforms, empty slots have no name
+    struct Uniform {
+        std::string Name;
+        GLuint Hash;
+        GLint Location;
+    };
+    std::vector<Uniform> uniforms;
+
+    // query all active uniforms of the linked program
+    void reflectUniforms();
+    void insertUniform(const std::string &name, GLint location);
+
     // check GLSL compile and linking errors
     void checkCompileErrors(GLuint object, std::string type);
 };
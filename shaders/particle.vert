@@ -1,16 +1,26 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 coord>
+// per particle, either instanced arrays or constant attribute values
+layout (location = 1) in vec2 offset;
+layout (location = 2) in vec4 color;
 
 out vec2 TexCoords;
 out vec4 ParticleColor;
 
-uniform mat4 projection;
-uniform vec2 offset;
-uniform vec4 color;
+layout (std140) uniform FrameData {
+    mat4 projection;
+    vec2 viewport;
+    float time;
+    bool confuse;
+    bool chaos;
+    bool shake;
+};
+
+uniform vec4 region; // <vec2 uv min, vec2 uv max>
 
 void main() {
     float scale = 10.0f;
-    TexCoords = vertex.zw;
+    TexCoords = mix(region.xy, region.zw, vertex.zw);
     ParticleColor = color;
     gl_Position = projection*vec4((vertex.xy*scale) + offset, 0.0, 1.0);
 }
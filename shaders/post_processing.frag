@@ -7,9 +7,14 @@ uniform vec2 offsets[9];
 uniform int edge_kernel[9];
 uniform float blur_kernel[9];
 
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
+layout (std140) uniform FrameData {
+    mat4 projection;
+    vec2 viewport;
+    float time;
+    bool confuse;
+    bool chaos;
+    bool shake;
+};
 
 void main() {
     color = vec4(0.0f);
@@ -3,10 +3,14 @@ layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 coord>
 
 out vec2 TexCoords;
 
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
-uniform float time;
+layout (std140) uniform FrameData {
+    mat4 projection;
+    vec2 viewport;
+    float time;
+    bool confuse;
+    bool chaos;
+    bool shake;
+};
 
 void main() {
     gl_Position = vec4(vertex.xy, 0.0f, 1.0f);
@@ -4,9 +4,18 @@ layout (location = 0) in vec4 vertex; //  <vec2 position, vec2 texCoords>
 out vec2 TexCoords;
 
 uniform mat4 model;
-uniform mat4 projection;
+uniform vec4 region; // <vec2 uv min, vec2 uv max>
+
+layout (std140) uniform FrameData {
+    mat4 projection;
+    vec2 viewport;
+    float time;
+    bool confuse;
+    bool chaos;
+    bool shake;
+};
 
 void main() {
-    TexCoords = vertex.zw;
+    TexCoords = mix(region.xy, region.zw, vertex.zw);
     gl_Position = projection*model*vec4(vertex.xy, 0.0, 1.0);
 }
@@ -0,0 +1,21 @@
+#version 330 core
+in vec2 TexCoords;
+in vec3 SpriteColor;
+flat in int TextureSlot;
+out vec4 color;
+
+// GLSL 3.30 only allows constant sampler array indices
+uniform sampler2D images[8];
+
+void main() {
+    vec4 texel;
+    if (TextureSlot == 0) texel = texture(images[0], TexCoords);
+    else if (TextureSlot == 1) texel = texture(images[1], TexCoords);
+    else if (TextureSlot == 2) texel = texture(images[2], TexCoords);
+    else if (TextureSlot == 3) texel = texture(images[3], TexCoords);
+    else if (TextureSlot == 4) texel = texture(images[4], TexCoords);
+    else if (TextureSlot == 5) texel = texture(images[5], TexCoords);
+    else if (TextureSlot == 6) texel = texture(images[6], TexCoords);
+    else texel = texture(images[7], TexCoords);
+    color = vec4(SpriteColor, 1.0)*texel;
+}
@@ -0,0 +1,35 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; //  <vec2 position, vec2 texCoords>
+// per instance
+layout (location = 1) in vec2 spritePosition;
+layout (location = 2) in vec2 spriteSize;
+layout (location = 3) in vec3 spriteColor;
+layout (location = 4) in float spriteRotation;
+layout (location = 5) in int spriteTexture;
+layout (location = 6) in vec4 spriteRegion; // <vec2 uv min, vec2 uv max>
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+flat out int TextureSlot;
+
+layout (std140) uniform FrameData {
+    mat4 projection;
+    vec2 viewport;
+    float time;
+    bool confuse;
+    bool chaos;
+    bool shake;
+};
+
+void main() {
+    TexCoords = mix(spriteRegion.xy, spriteRegion.zw, vertex.zw);
+    SpriteColor = spriteColor;
+    TextureSlot = spriteTexture;
+
+    // rotate about the sprite center, then move to position
+    vec2 local = (vertex.xy - 0.5)*spriteSize;
+    float s = sin(spriteRotation);
+    float c = cos(spriteRotation);
+    vec2 rotated = vec2(c*local.x - s*local.y, s*local.x + c*local.y);
+    gl_Position = projection*vec4(spritePosition + 0.5*spriteSize + rotated, 0.0, 1.0);
+}
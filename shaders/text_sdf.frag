@@ -0,0 +1,15 @@
+#version 330 core
+in vec2 TexCoords;
+in vec3 TextColor;
+out vec4 color;
+
+// signed distance field, 0.5 is the glyph edge
+uniform sampler2D text;
+
+void main() {
+    float distance = texture(text, TexCoords).r;
+    // keep the edge about one screen pixel wide at any scale
+    float width = fwidth(distance);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+    color = vec4(TextColor, alpha);
+}
@@ -0,0 +1,149 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "sprite_batch.h"
+#include "gl_state.h"
+
+#include <cstddef>
+#include <string>
+
+SpriteBatch::SpriteBatch(const Shader &shader, GLuint capacity)
+    : DrawCalls(0), SpriteCount(0), shader(shader), capacity(capacity), textureCount(0) {
+    this->instances.reserve(capacity);
+    this->initRenderData();
+
+    // each sampler in the array reads from the texture unit matching its slot
+    this->shader.Use();
+    for (GLuint i = 0; i < SPRITE_BATCH_TEXTURE_SLOTS; ++i) {
+        std::string name = "images[" + std::to_string(i) + "]";
+        this->shader.SetInteger(name.c_str(), i);
+    }
+}
+
+SpriteBatch::~SpriteBatch() {
+    GLState::DeleteVertexArrays(1, &this->quadVAO);
+    GLState::DeleteBuffers(1, &this->quadVBO);
+    GLState::DeleteBuffers(1, &this->instanceVBO);
+}
+
+void SpriteBatch::Begin() {
+    this->instances.clear();
+    this->textureCount = 0;
+}
+
+void SpriteBatch::Submit(const Texture2D &texture, glm::vec2 position, glm::vec2 size, GLfloat rotate, glm::vec3 color) {
+    this->Submit(texture.ID, texture.Region, position, size, rotate, color);
+}
+
+void SpriteBatch::Submit(GLuint textureID, glm::vec4 region, glm::vec2 position, glm::vec2 size, GLfloat rotate, glm::vec3 color) {
+    if (this->instances.size() >= this->capacity)
+        this->Flush();
+
+    GLint slot = this->textureSlot(textureID);
+    if (slot < 0) {
+        // out of texture slots, draw what we have and start over
+        this->Flush();
+        slot = this->textureSlot(textureID);
+    }
+
+    SpriteInstance instance;
+    instance.Position = position;
+    instance.Size = size;
+    instance.Color = color;
+    instance.Rotation = rotate;
+    instance.TextureSlot = slot;
+    instance.Region = region;
+    this->instances.push_back(instance);
+}
+
+void SpriteBatch::Flush() {
+    if (this->instances.empty()) {
+        this->textureCount = 0;
+        return;
+    }
+
+    this->shader.Use();
+    for (GLuint i = 0; i < this->textureCount; ++i)
+        GLState::BindTexture(i, this->textures[i]);
+
+    // orphan the old storage so the driver does not stall on the previous draw
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, this->capacity*sizeof(SpriteInstance), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, this->instances.size()*sizeof(SpriteInstance), &this->instances[0]);
+
+    GLState::BindVertexArray(this->quadVAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, this->instances.size());
+
+    ++this->DrawCalls;
+    this->SpriteCount += this->instances.size();
+    this->Begin();
+}
+
+void SpriteBatch::ResetStats() {
+    this->DrawCalls = 0;
+    this->SpriteCount = 0;
+}
+
+GLint SpriteBatch::textureSlot(GLuint textureID) {
+    for (GLuint i = 0; i < this->textureCount; ++i) {
+        if (this->textures[i] == textureID)
+            return i;
+    }
+    if (this->textureCount == SPRITE_BATCH_TEXTURE_SLOTS)
+        return -1;
+    this->textures[this->textureCount] = textureID;
+    return this->textureCount++;
+}
+
+void SpriteBatch::initRenderData() {
+    GLfloat vertices[] = {
+//     data layout
+//     pos.x,pos.y,tex.x,tex.y
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f,
+
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f
+    };
+
+    glGenVertexArrays(1, &this->quadVAO);
+    glGenBuffers(1, &this->quadVBO);
+    glGenBuffers(1, &this->instanceVBO);
+
+    GLState::BindVertexArray(this->quadVAO);
+
+    // shared quad
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (GLvoid*)0);
+
+    // per instance data, advanced once per sprite
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, this->capacity*sizeof(SpriteInstance), NULL, GL_STREAM_DRAW);
+    GLsizei stride = sizeof(SpriteInstance);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(SpriteInstance, Position));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(SpriteInstance, Size));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(SpriteInstance, Color));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(SpriteInstance, Rotation));
+    glEnableVertexAttribArray(5);
+    glVertexAttribIPointer(5, 1, GL_INT, stride, (GLvoid*)offsetof(SpriteInstance, TextureSlot));
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(SpriteInstance, Region));
+    for (GLuint i = 1; i <= 6; ++i)
+        glVertexAttribDivisor(i, 1);
+
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
+}
@@ -0,0 +1,75 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "texture.h"
+#include "shader.h"
+
+// Number of textures a single batch can sample from (must match sprite_batch.frag)
+const GLuint SPRITE_BATCH_TEXTURE_SLOTS = 8;
+
+// Per sprite data streamed to the GPU as instanced vertex attributes
+struct SpriteInstance {
+    glm::vec2 Position;
+    glm::vec2 Size;
+    glm::vec3 Color;
+    GLfloat Rotation;
+    GLint TextureSlot;
+    glm::vec4 Region;
+};
+
+// SpriteBatch collects sprites between Begin and Flush and renders them
+// with as few instanced draw calls as possible. A batch is only split
+// when it runs out of instance capacity or texture slots.
+class SpriteBatch {
+public:
+    // Statistics, reset with ResetStats (usually once per frame)
+    GLuint DrawCalls;
+    GLuint SpriteCount;
+
+    // Constructor destructor
+    SpriteBatch(const Shader &shader, GLuint capacity=1024);
+    ~SpriteBatch();
+
+    // Start collecting sprites, discards anything not yet flushed
+    void Begin();
+    // Queue a sprite, flushes automatically when the batch is full
+    void Submit(const Texture2D &texture, glm::vec2 position, glm::vec2 size=glm::vec2(10, 10), GLfloat rotate=0.0f, glm::vec3 color=glm::vec3(1.0f));
+    // Queue a sprite showing region <u0, v0, u1, v1> of texture textureID
+    void Submit(GLuint textureID, glm::vec4 region, glm::vec2 position, glm::vec2 size, GLfloat rotate, glm::vec3 color);
+    // Render all queued sprites
+    void Flush();
+
+    void ResetStats();
+    // Program the sprites are drawn with
+    GLuint ProgramID() const { return this->shader.ID; }
+
+private:
+    // internal state
+    Shader shader;
+    GLuint quadVAO;
+    GLuint quadVBO;
+    GLuint instanceVBO;
+    GLuint capacity;
+    std::vector<SpriteInstance> instances;
+    GLuint textures[SPRITE_BATCH_TEXTURE_SLOTS];
+    GLuint textureCount;
+
+    // Returns the slot texture is bound to in this batch, or -1 if all slots are taken
+    GLint textureSlot(GLuint textureID);
+    void initRenderData();
+};
+
+#endif
@@ -7,14 +7,18 @@
 ** option) any later version.
 ******************************************************************/
 #include "sprite_renderer.h"
+#include "gl_state.h"
 
 SpriteRenderer::SpriteRenderer(const Shader &shader) {
     this->shader = shader;
+    this->modelUniform = this->shader.GetUniform<glm::mat4>("model");
+    this->colorUniform = this->shader.GetUniform<glm::vec3>("spriteColor");
+    this->regionUniform = this->shader.GetUniform<glm::vec4>("region");
     this->initRenderData();
 }
 
 SpriteRenderer::~SpriteRenderer() {
-    glDeleteVertexArrays(1, &this->quadVAO);
+    GLState::DeleteVertexArrays(1, &this->quadVAO);
 }
 
 void SpriteRenderer::DrawSprite(const Texture2D &texture, glm::vec2 position, glm::vec2 size, GLfloat rotate, glm::vec3 color) {
@@ -31,17 +35,16 @@ void SpriteRenderer::DrawSprite(const Texture2D &texture, glm::vec2 position, gl
     model = glm::scale(model, glm::vec3(size, 1.0f)); // scale
 
     // send uniform data to GPU
-    this->shader.SetMatrix4("model", model);
-    this->shader.SetVector3f("spriteColor", color);
+    this->modelUniform.Set(model);
+    this->colorUniform.Set(color);
+    this->regionUniform.Set(texture.Region);
 
     // set active texture
-    glActiveTexture(GL_TEXTURE0);
     texture.Bind();
 
     // draw sprite
-    glBindVertexArray(this->quadVAO);
+    GLState::BindVertexArray(this->quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
 }
 
 void SpriteRenderer::initRenderData() {
@@ -65,13 +68,13 @@ void SpriteRenderer::initRenderData() {
     glGenBuffers(1, &VBO);
 
     // load vertex buffer object
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
     // tell the shader how to unpack vertices
-    glBindVertexArray(this->quadVAO);
+    GLState::BindVertexArray(this->quadVAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (GLvoid*)0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
 }
@@ -27,6 +27,9 @@ public:
 private:
     // internal state
     Shader shader;
+    UniformHandle<glm::mat4> modelUniform;
+    UniformHandle<glm::vec3> colorUniform;
+    UniformHandle<glm::vec4> regionUniform;
     GLuint quadVAO;
 
     void initRenderData();
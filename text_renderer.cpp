@@ -6,6 +6,9 @@
 ** Creative Commons, either version 4 of the License, or (at your
 ** option) any later version.
 ******************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <iostream>
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -14,123 +17,328 @@
 
 #include "text_renderer.h"
 #include "resource_manager.h"
+#include "resource_names.h"
+#include "texture_atlas.h"
+#include "gl_state.h"
 
-TextRenderer::TextRenderer(GLuint width, GLuint height) {
-    // Load and configure shader
-    this->TextShader = ResourceManager::LoadShader("shaders/text.vert", "shaders/text.frag", nullptr, "text");
-    this->TextShader.SetMatrix4("projection", glm::ortho(0.0f, static_cast<GLfloat>(width), static_cast<GLfloat>(height), 0.0f), GL_TRUE);
-    this->TextShader.SetInteger("text", 0);
-    // Configure VAO/VBO for texture quads
+namespace {
+    const GLfloat FAR_AWAY = 1e20f;
+
+    // Squared distance transform of one row or column, Felzenszwalb and Huttenlocher
+    void distanceTransform(const std::vector<GLfloat> &f, std::vector<GLfloat> &d, GLuint n, std::vector<GLint> &v, std::vector<GLfloat> &z) {
+        GLint k = 0;
+        v[0] = 0;
+        z[0] = -FAR_AWAY;
+        z[1] = FAR_AWAY;
+        for (GLint q = 1; q < (GLint)n; ++q) {
+            GLfloat s = ((f[q] + q*q) - (f[v[k]] + v[k]*v[k])) / (2*q - 2*v[k]);
+            while (s <= z[k]) {
+                --k;
+                s = ((f[q] + q*q) - (f[v[k]] + v[k]*v[k])) / (2*q - 2*v[k]);
+            }
+            ++k;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = FAR_AWAY;
+        }
+        k = 0;
+        for (GLint q = 0; q < (GLint)n; ++q) {
+            while (z[k + 1] < q)
+                ++k;
+            d[q] = (q - v[k])*(q - v[k]) + f[v[k]];
+        }
+    }
+
+    // In place 2D squared distance transform, grid holds 0 at feature pixels and FAR_AWAY elsewhere
+    void distanceTransform(std::vector<GLfloat> &grid, GLuint width, GLuint height) {
+        GLuint n = std::max(width, height);
+        std::vector<GLfloat> f(n), d(n), z(n + 1);
+        std::vector<GLint> v(n);
+        for (GLuint x = 0; x < width; ++x) {
+            for (GLuint y = 0; y < height; ++y)
+                f[y] = grid[y*width + x];
+            distanceTransform(f, d, height, v, z);
+            for (GLuint y = 0; y < height; ++y)
+                grid[y*width + x] = d[y];
+        }
+        for (GLuint y = 0; y < height; ++y) {
+            for (GLuint x = 0; x < width; ++x)
+                f[x] = grid[y*width + x];
+            distanceTransform(f, d, width, v, z);
+            for (GLuint x = 0; x < width; ++x)
+                grid[y*width + x] = d[x];
+        }
+    }
+
+    // Convert a coverage bitmap to a signed distance field, size is updated to the field size
+    std::vector<unsigned char> distanceField(const std::vector<unsigned char> &bitmap, glm::uvec2 &size) {
+        // work on the raster with room for the spread on every side
+        const GLuint spread = TEXT_SDF_SPREAD*TEXT_SDF_OVERSAMPLE;
+        GLuint width = size.x + 2*spread;
+        GLuint height = size.y + 2*spread;
+        std::vector<GLfloat> inside(width*height, FAR_AWAY), outside(width*height, FAR_AWAY);
+        for (GLuint y = 0; y < size.y; ++y) {
+            for (GLuint x = 0; x < size.x; ++x) {
+                GLuint i = (y + spread)*width + x + spread;
+                if (bitmap[y*size.x + x] >= 128)
+                    inside[i] = 0.0f;
+                else
+                    outside[i] = 0.0f;
+            }
+        }
+        for (GLuint y = 0; y < height; ++y) {
+            for (GLuint x = 0; x < width; ++x) {
+                if (x < spread || y < spread || x >= size.x + spread || y >= size.y + spread)
+                    outside[y*width + x] = 0.0f;
+            }
+        }
+        // distance to the nearest inside pixel, and to the nearest outside pixel
+        distanceTransform(inside, width, height);
+        distanceTransform(outside, width, height);
+
+        // point sample the centre of every block of TEXT_SDF_OVERSAMPLE^2 pixels,
+        // 0.5 is the glyph edge and the value is larger inside
+        size = glm::uvec2(width / TEXT_SDF_OVERSAMPLE, height / TEXT_SDF_OVERSAMPLE);
+        std::vector<unsigned char> field(size.x*size.y);
+        for (GLuint y = 0; y < size.y; ++y) {
+            for (GLuint x = 0; x < size.x; ++x) {
+                GLuint i = (y*TEXT_SDF_OVERSAMPLE + TEXT_SDF_OVERSAMPLE/2)*width + x*TEXT_SDF_OVERSAMPLE + TEXT_SDF_OVERSAMPLE/2;
+                GLfloat distance = std::sqrt(inside[i]) - std::sqrt(outside[i]);
+                GLfloat value = 0.5f - distance / (2.0f*spread);
+                field[y*size.x + x] = static_cast<unsigned char>(std::min(std::max(value, 0.0f), 1.0f)*255.0f);
+            }
+        }
+        return field;
+    }
+}
+
+TextRenderer::TextRenderer()
+    : Mode(TEXT_BITMAP), capacity(0), lineTop(0.0f) {
+    for (GLuint c = 0; c < TEXT_GLYPH_COUNT; ++c)
+        this->Characters[c] = Character();
+    // Configure VAO/VBO for texture quads, storage is allocated on the first Flush
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &this->VBO);
-    glBindVertexArray(this->VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*6*4, NULL, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    this->initVertexArray(this->VAO, this->VBO);
+}
+
+void TextRenderer::Load(std::string font, GLuint fontSize, TextRenderMode mode) {
+    ShaderHandle shader;
+    if (mode == TEXT_SDF)
+        shader = ResourceManager::LoadShader("shaders/text.vert", "shaders/text_sdf.frag", nullptr, SHADER_TEXT_SDF);
+    else
+        shader = ResourceManager::LoadShader("shaders/text.vert", "shaders/text.frag", nullptr, SHADER_TEXT);
+    this->Load(RasterizeFont(font, fontSize, mode), ResourceManager::GetShader(shader));
+}
+
+void TextRenderer::Load(const FontRaster &raster, const Shader &shader) {
+    for (GLuint c = 0; c < TEXT_GLYPH_COUNT; ++c)
+        this->Characters[c] = raster.Characters[c];
+    this->lineTop = raster.LineTop;
+    this->Mode = raster.Mode;
+    this->TextShader = shader;
+    this->TextShader.SetInteger("text", 0, GL_TRUE);
+    if (raster.Pixels.empty())
+        return;
+
+    // Disable byte-alignment restriction
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    this->Atlas.Internal_Format = GL_RED;
+    this->Atlas.Image_Format = GL_RED;
+    this->Atlas.Wrap_S = GL_CLAMP_TO_EDGE;
+    this->Atlas.Wrap_T = GL_CLAMP_TO_EDGE;
+    this->Atlas.Filter_Min = GL_LINEAR;
+    this->Atlas.Generate(raster.Size, raster.Size, const_cast<unsigned char*>(&raster.Pixels[0]));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 
-void TextRenderer::Load(std::string font, GLuint fontSize) {
-    // First clear the previously loaded Characters
-    this->Characters.clear();
-    // Then initialize and load the FreeType library
+FontRaster RasterizeFont(const std::string &font, GLuint fontSize, TextRenderMode mode) {
+    FontRaster raster;
+    for (GLuint c = 0; c < TEXT_GLYPH_COUNT; ++c)
+        raster.Characters[c] = Character();
+    raster.LineTop = 0.0f;
+    raster.Mode = mode;
+    raster.Size = 0;
+    // Initialize and load the FreeType library, every call has its own so fonts can be rasterized in parallel
     FT_Library ft;
-    if (FT_Init_FreeType(&ft)) // All functions return a value different than 0 whenever an error occurred
+    if (FT_Init_FreeType(&ft)) { // All functions return a value different than 0 whenever an error occurred
         std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+        return raster;
+    }
     // Load font as face
     FT_Face face;
-    if (FT_New_Face(ft, font.c_str(), 0, &face))
+    if (FT_New_Face(ft, font.c_str(), 0, &face)) {
         std::cout << "ERROR::FREETYPE: Failed to load font: " << font.c_str() << std::endl;
-    // Set size to load glyphs as
-    FT_Set_Pixel_Sizes(face, 0, fontSize);
-    // Disable byte-alignment restriction
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    // Then for the first 128 ASCII characters, pre-load/compile their characters and store them
-    // lol see what I did there
-    for (GLubyte c = 0; c < 128; c++) {
+        FT_Done_FreeType(ft);
+        return raster;
+    }
+    // Set size to load glyphs as, distance fields are computed from a larger rendering
+    GLuint rasterSize = (mode == TEXT_SDF) ? TEXT_SDF_SIZE*TEXT_SDF_OVERSAMPLE : fontSize;
+    FT_Set_Pixel_Sizes(face, 0, rasterSize);
+    // scale from raster pixels to font size pixels
+    GLfloat metricScale = static_cast<GLfloat>(fontSize) / rasterSize;
+
+    // Rasterize the first 128 ASCII characters and keep their bitmaps until they are packed
+    std::vector<std::vector<unsigned char>> bitmaps(TEXT_GLYPH_COUNT);
+    std::vector<glm::uvec2> sizes(TEXT_GLYPH_COUNT);
+    for (GLubyte c = 0; c < TEXT_GLYPH_COUNT; c++) {
         // Load character glyph
         if (FT_Load_Char(face, c, FT_LOAD_RENDER))
         {
             std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
             continue;
         }
-        // Generate texture
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-            );
-        // Set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        // Now store character for later use
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            face->glyph->advance.x
-        };
-        Characters.insert(std::pair<GLchar, Character>(c, character));
+        FT_Bitmap &bitmap = face->glyph->bitmap;
+        for (GLuint row = 0; row < bitmap.rows; ++row) {
+            const unsigned char* line = bitmap.buffer + row*bitmap.pitch;
+            bitmaps[c].insert(bitmaps[c].end(), line, line + bitmap.width);
+        }
+        sizes[c] = glm::uvec2(bitmap.width, bitmap.rows);
+
+        Character &character = raster.Characters[c];
+        glm::vec2 bearing(face->glyph->bitmap_left, face->glyph->bitmap_top);
+        character.Advance = static_cast<GLuint>(face->glyph->advance.x*metricScale);
+        if (c == 'H')
+            raster.LineTop = bearing.y*metricScale;
+
+        if (mode == TEXT_SDF && bitmap.width > 0 && bitmap.rows > 0) {
+            bitmaps[c] = distanceField(bitmaps[c], sizes[c]);
+            // the field is one texel per TEXT_SDF_OVERSAMPLE raster pixels plus its border
+            GLfloat spread = TEXT_SDF_SPREAD*TEXT_SDF_OVERSAMPLE;
+            bearing += glm::vec2(-spread, spread);
+            character.Size = glm::vec2(sizes[c])*static_cast<GLfloat>(TEXT_SDF_OVERSAMPLE)*metricScale;
+        } else {
+            character.Size = glm::vec2(sizes[c])*metricScale;
+        }
+        character.Bearing = bearing*metricScale;
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
     // Destroy FreeType once we're finished
     FT_Done_Face(face);
     FT_Done_FreeType(ft);
+
+    // Pack all glyphs into one page, growing it until everything fits
+    const GLuint padding = 1;
+    GLuint size = 128;
+    std::vector<glm::uvec2> positions(TEXT_GLYPH_COUNT);
+    GLboolean packed = GL_FALSE;
+    while (!packed) {
+        SkylinePacker packer(size, size);
+        packed = GL_TRUE;
+        for (GLuint c = 0; c < TEXT_GLYPH_COUNT && packed; ++c) {
+            if (sizes[c].x == 0 || sizes[c].y == 0)
+                continue;
+            packed = packer.Pack(sizes[c].x + padding, sizes[c].y + padding, positions[c].x, positions[c].y);
+        }
+        if (!packed)
+            size *= 2;
+    }
+
+    std::vector<unsigned char> pixels(size*size, 0);
+    for (GLuint c = 0; c < TEXT_GLYPH_COUNT; ++c) {
+        for (GLuint row = 0; row < sizes[c].y; ++row) {
+            std::vector<unsigned char>::const_iterator line = bitmaps[c].begin() + row*sizes[c].x;
+            std::copy(line, line + sizes[c].x, pixels.begin() + (positions[c].y + row)*size + positions[c].x);
+        }
+        GLfloat scale = 1.0f / size;
+        raster.Characters[c].Region = glm::vec4(positions[c].x*scale, positions[c].y*scale,
+            (positions[c].x + sizes[c].x)*scale, (positions[c].y + sizes[c].y)*scale);
+    }
+    raster.Size = size;
+    raster.Pixels.swap(pixels);
+    return raster;
 }
 
 void TextRenderer::RenderText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color) {
-    // Activate corresponding render state
-    this->TextShader.Use();
-    this->TextShader.SetVector3f("textColor", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->VAO);
+    this->QueueText(text, x, y, scale, color);
+    this->Flush();
+}
+
+void TextRenderer::QueueText(const std::string &text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color) {
+    this->layout(text, x, y, scale, color, this->vertices);
+}
 
+void TextRenderer::layout(const std::string &text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color, std::vector<TextVertex> &vertices) const {
     // Iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++) {
-        Character ch = Characters[*c];
+    for (std::string::const_iterator c = text.begin(); c != text.end(); c++) {
+        unsigned char code = static_cast<unsigned char>(*c);
+        if (code >= TEXT_GLYPH_COUNT)
+            continue;
+        const Character &ch = this->Characters[code];
 
         GLfloat xpos = x + ch.Bearing.x * scale;
-        GLfloat ypos = y + (this->Characters['H'].Bearing.y - ch.Bearing.y) * scale;
+        GLfloat ypos = y + (this->lineTop - ch.Bearing.y) * scale;
 
         GLfloat w = ch.Size.x * scale;
         GLfloat h = ch.Size.y * scale;
-        // Update VBO for each character
-        GLfloat vertices[6][4] = {
-            { xpos,     ypos + h,   0.0, 1.0 },
-            { xpos + w, ypos,       1.0, 0.0 },
-            { xpos,     ypos,       0.0, 0.0 },
-
-            { xpos,     ypos + h,   0.0, 1.0 },
-            { xpos + w, ypos + h,   1.0, 1.0 },
-            { xpos + w, ypos,       1.0, 0.0 }
+        const glm::vec4 &uv = ch.Region;
+        // Two triangles per glyph
+        TextVertex quad[6] = {
+            { glm::vec2(xpos,     ypos + h), glm::vec2(uv.x, uv.w), color },
+            { glm::vec2(xpos + w, ypos),     glm::vec2(uv.z, uv.y), color },
+            { glm::vec2(xpos,     ypos),     glm::vec2(uv.x, uv.y), color },
+
+            { glm::vec2(xpos,     ypos + h), glm::vec2(uv.x, uv.w), color },
+            { glm::vec2(xpos + w, ypos + h), glm::vec2(uv.z, uv.w), color },
+            { glm::vec2(xpos + w, ypos),     glm::vec2(uv.z, uv.y), color }
         };
-        // Render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // Update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // Be sure to use glBufferSubData and not glBufferData
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // Render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        vertices.insert(vertices.end(), quad, quad + 6);
         // Now advance cursors for next glyph
         x += (ch.Advance >> 6) * scale; // Bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
     }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void TextRenderer::Flush() {
+    if (this->vertices.empty())
+        return;
+
+    // Activate corresponding render state
+    this->TextShader.Use();
+    this->Atlas.Bind();
+    GLState::BindVertexArray(this->VAO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->VBO);
+
+    // Upload every queued quad at once, orphaning the previous storage
+    this->capacity = std::max<GLuint>(this->capacity, this->vertices.size());
+    glBufferData(GL_ARRAY_BUFFER, this->capacity*sizeof(TextVertex), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, this->vertices.size()*sizeof(TextVertex), &this->vertices[0]);
+    glDrawArrays(GL_TRIANGLES, 0, this->vertices.size());
+
+    this->vertices.clear();
+}
+
+GLuint TextRenderer::CreateMesh(const std::string &text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color) {
+    TextMesh mesh;
+    mesh.Text = text;
+    mesh.X = x;
+    mesh.Y = y;
+    mesh.Scale = scale;
+    mesh.Color = color;
+    this->layout(text, x, y, scale, color, mesh.Vertices);
+    this->meshes.push_back(mesh);
+    return this->meshes.size() - 1;
+}
+
+void TextRenderer::UpdateMesh(GLuint mesh, const std::string &text) {
+    TextMesh &textMesh = this->meshes[mesh];
+    if (textMesh.Text == text)
+        return;
+    textMesh.Text = text;
+    textMesh.Vertices.clear();
+    this->layout(text, textMesh.X, textMesh.Y, textMesh.Scale, textMesh.Color, textMesh.Vertices);
+}
+
+void TextRenderer::DrawMesh(GLuint mesh) {
+    const TextMesh &textMesh = this->meshes[mesh];
+    this->vertices.insert(this->vertices.end(), textMesh.Vertices.begin(), textMesh.Vertices.end());
+}
+
+void TextRenderer::initVertexArray(GLuint VAO, GLuint VBO) {
+    GLState::BindVertexArray(VAO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (GLvoid*)offsetof(TextVertex, Position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (GLvoid*)offsetof(TextVertex, Color));
+    GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::BindVertexArray(0);
 }
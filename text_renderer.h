@@ -9,7 +9,8 @@
 #ifndef TEXT_RENDERER_H
 #define TEXT_RENDERER_H
 
-#include <map>
+#include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -17,33 +18,113 @@
 #include "texture.h"
 #include "shader.h"
 
+// Number of codepoints loaded from the font (ASCII)
+const GLuint TEXT_GLYPH_COUNT = 128;
+
+// Signed distance field glyphs are stored with this em size in the atlas,
+// rasterized at TEXT_SDF_OVERSAMPLE times that size, and carry a border of
+// TEXT_SDF_SPREAD texels in which the distance falls off
+const GLuint TEXT_SDF_SIZE = 32;
+const GLuint TEXT_SDF_OVERSAMPLE = 4;
+const GLuint TEXT_SDF_SPREAD = 4;
+
+// How glyphs are stored in the atlas
+enum TextRenderMode {
+    TEXT_BITMAP,    // coverage bitmaps rasterized at the font size
+    TEXT_SDF        // signed distance fields, sharp at any scale
+};
+
 
 /// Holds all state information relevant to a character as loaded using FreeType
 struct Character {
-    GLuint TextureID;   // ID handle of the glyph texture
-    glm::ivec2 Size;    // Size of glyph
-    glm::ivec2 Bearing; // Offset from baseline to left/top of glyph
-    GLuint Advance;     // Horizontal offset to advance to next glyph
+    glm::vec4 Region;   // Area of the glyph in the atlas <u0, v0, u1, v1>
+    glm::vec2 Size;     // Size of glyph
+    glm::vec2 Bearing;  // Offset from baseline to left/top of glyph
+    GLuint Advance;     // Horizontal offset to advance to next glyph (1/64 pixels)
+};
+
+// Glyph metrics and the packed single channel glyph page of a font, made
+// without OpenGL so fonts can be rasterized on any thread
+struct FontRaster {
+    Character Characters[TEXT_GLYPH_COUNT];
+    // Bearing of 'H', used to align glyphs on a common top line
+    GLfloat LineTop;
+    TextRenderMode Mode;
+    // Width and height of the page in texels
+    GLuint Size;
+    std::vector<unsigned char> Pixels;
+};
+
+// Rasterize the first TEXT_GLYPH_COUNT codepoints of a font with FreeType and pack them into one page
+FontRaster RasterizeFont(const std::string &font, GLuint fontSize, TextRenderMode mode = TEXT_BITMAP);
+
+// Vertex layout of the text quads
+struct TextVertex {
+    glm::vec2 Position;
+    glm::vec2 TexCoords;
+    glm::vec3 Color;
+};
+
+
+// A string laid out once, its quads are copied into the batch when drawn
+struct TextMesh {
+    std::string Text;
+    GLfloat X, Y, Scale;
+    glm::vec3 Color;
+    std::vector<TextVertex> Vertices;
 };
 
 
 // A renderer class for rendering text displayed by a font loaded using the
-// FreeType library. A single font is loaded, processed into a list of Character
-// items for later rendering.
+// FreeType library. All glyphs of the font are packed into a single atlas
+// texture, so any number of strings can be drawn with one draw call:
+// queue them with QueueText and draw them with Flush. Strings that rarely
+// change should be created as meshes and queued by handle instead, which
+// skips laying them out again but still draws them in the same batch.
 class TextRenderer {
 public:
-    // Holds a list of pre-compiled Characters
-    std::map<GLchar, Character> Characters;
-    // Shader used for text rendering
+    // Pre-compiled Characters, indexed by codepoint
+    Character Characters[TEXT_GLYPH_COUNT];
+    // Texture holding every glyph
+    Texture2D Atlas;
+    // Shader used for text rendering, depends on the render mode
     Shader TextShader;
-    // Constructor
-    TextRenderer(GLuint width, GLuint height);
+    TextRenderMode Mode;
+    // Constructor, nothing can be drawn before a font is loaded
+    TextRenderer();
 
-    void Load(std::string font, GLuint fontSize);
+    // Load a font, sizes and scales passed to the draw functions are relative to fontSize.
+    // Compiles the shader of the mode right away.
+    void Load(std::string font, GLuint fontSize, TextRenderMode mode = TEXT_BITMAP);
+    // Upload a font rasterized with RasterizeFont, drawn with a shader built from
+    // shaders/text.vert and shaders/text.frag or shaders/text_sdf.frag for TEXT_SDF
+    void Load(const FontRaster &raster, const Shader &shader);
+    // Draw a single string immediately
     void RenderText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color = glm::vec3(1.0f));
+    // Add a string to the pending batch
+    void QueueText(const std::string &text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color = glm::vec3(1.0f));
+    // Draw all queued strings
+    void Flush();
+
+    // Lay out a string once, returns the handle used to draw it
+    GLuint CreateMesh(const std::string &text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color = glm::vec3(1.0f));
+    // Replace the text of a mesh, only lays it out again if the text differs
+    void UpdateMesh(GLuint mesh, const std::string &text);
+    // Add a mesh to the pending batch, drawn by the next Flush
+    void DrawMesh(GLuint mesh);
 private:
     // Render state
     GLuint VAO, VBO;
+    GLuint capacity;
+    std::vector<TextVertex> vertices;
+    std::vector<TextMesh> meshes;
+    // Bearing of 'H', used to align glyphs on a common top line
+    GLfloat lineTop;
+
+    // Configure the vertex layout of a text VAO
+    void initVertexArray(GLuint VAO, GLuint VBO);
+    // Append the quads of a string to vertices
+    void layout(const std::string &text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color, std::vector<TextVertex> &vertices) const;
 };
 
 #endif
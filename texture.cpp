@@ -8,18 +8,16 @@
 ******************************************************************/
 
 #include "texture.h"
-
-Texture2D::Texture2D()
-    : Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR_MIPMAP_LINEAR), Filter_Max(GL_LINEAR) {
-    glGenTextures(1, &this->ID);
-}
+#include "gl_state.h"
 
 void Texture2D::Generate(GLuint width, GLuint height, unsigned char* data) {
     this->Width = width;
     this->Height = height;
+    if (this->ID == 0)
+        glGenTextures(1, &this->ID);
 
     // associate data with OpenGL texture ID
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+    GLState::BindTexture(0, this->ID);
     glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
 
     glGenerateMipmap(GL_TEXTURE_2D);
@@ -30,9 +28,34 @@ void Texture2D::Generate(GLuint width, GLuint height, unsigned char* data) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::BindTexture(0, 0);
+}
+
+void Texture2D::Generate(GLuint width, GLuint height, GLuint levels, unsigned char* const* data) {
+    this->Width = width;
+    this->Height = height;
+    if (this->ID == 0)
+        glGenTextures(1, &this->ID);
+
+    GLState::BindTexture(0, this->ID);
+    for (GLuint level = 0; level < levels; ++level) {
+        GLuint levelWidth = width >> level, levelHeight = height >> level;
+        glTexImage2D(GL_TEXTURE_2D, level, this->Internal_Format, levelWidth > 0 ? levelWidth : 1, levelHeight > 0 ? levelHeight : 1,
+            0, this->Image_Format, GL_UNSIGNED_BYTE, data[level]);
+    }
+    // the chain may stop short of 1x1, keep sampling to the levels that exist
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+    // set OpenGL parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->Wrap_S);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->Wrap_T);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
+
+    GLState::BindTexture(0, 0);
 }
 
-void Texture2D::Bind() const {
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+void Texture2D::Bind(GLuint unit) const {
+    GLState::BindTexture(unit, this->ID);
 }
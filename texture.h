@@ -10,6 +10,7 @@
 #define TEXTURE_H
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 
 // Arbitray shader class
 class Texture2D {
@@ -28,14 +29,24 @@ public:
     GLuint Filter_Min;
     GLuint Filter_Max;
 
-    // Constructor
-    Texture2D();
+    // area of the texture this handle covers <u0, v0, u1, v1>, only a
+    // part of it when the image was packed into an atlas page
+    glm::vec4 Region;
+
+    // Constructor, makes no OpenGL calls so objects holding a texture can
+    // exist without a context. The texture object is created by Generate
+    Texture2D()
+        : ID(0), Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT),
+          Filter_Min(GL_LINEAR_MIPMAP_LINEAR), Filter_Max(GL_LINEAR), Region(0.0f, 0.0f, 1.0f, 1.0f) { }
 
     // Load texture from image
     void Generate(GLuint widht, GLuint height, unsigned char* data);
+    // Load texture with a precomputed mip chain, data[i] holds level i which is
+    // max(1, width >> i) by max(1, height >> i), no mipmaps are generated
+    void Generate(GLuint width, GLuint height, GLuint levels, unsigned char* const* data);
 
-    // set as current texture
-    void Bind() const;
+    // set as current texture of a texture unit
+    void Bind(GLuint unit=0) const;
 };
 
 #endif
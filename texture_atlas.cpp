@@ -0,0 +1,194 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "texture_atlas.h"
+#include "gl_state.h"
+
+#include <algorithm>
+#include <iostream>
+
+SkylinePacker::SkylinePacker(GLuint width, GLuint height) {
+    this->Reset(width, height);
+}
+
+void SkylinePacker::Reset(GLuint width, GLuint height) {
+    this->width = width;
+    this->height = height;
+    this->skyline.clear();
+    Segment ground = {0, 0, width};
+    this->skyline.push_back(ground);
+}
+
+GLboolean SkylinePacker::Pack(GLuint width, GLuint height, GLuint &x, GLuint &y) {
+    // find the segment giving the lowest resting position, ties go to the narrowest
+    GLint best = -1;
+    GLuint bestY = 0, bestWidth = 0;
+    for (GLuint i = 0; i < this->skyline.size(); ++i) {
+        GLint top = this->fit(i, width, height);
+        if (top < 0)
+            continue;
+        if (best < 0 || (GLuint)top < bestY || ((GLuint)top == bestY && this->skyline[i].Width < bestWidth)) {
+            best = i;
+            bestY = top;
+            bestWidth = this->skyline[i].Width;
+        }
+    }
+    if (best < 0)
+        return GL_FALSE;
+
+    x = this->skyline[best].X;
+    y = bestY;
+
+    // raise the skyline under the new rectangle and trim the segments it covers
+    Segment raised = {x, y + height, width};
+    this->skyline.insert(this->skyline.begin() + best, raised);
+    for (GLuint i = best + 1; i < this->skyline.size(); ) {
+        Segment &segment = this->skyline[i];
+        GLuint end = raised.X + raised.Width;
+        if (segment.X >= end)
+            break;
+        GLuint shrink = end - segment.X;
+        if (segment.Width <= shrink) {
+            this->skyline.erase(this->skyline.begin() + i);
+        } else {
+            segment.X += shrink;
+            segment.Width -= shrink;
+            break;
+        }
+    }
+
+    // merge neighbouring segments at the same height
+    for (GLuint i = 0; i + 1 < this->skyline.size(); ) {
+        if (this->skyline[i].Y == this->skyline[i + 1].Y) {
+            this->skyline[i].Width += this->skyline[i + 1].Width;
+            this->skyline.erase(this->skyline.begin() + i + 1);
+        } else {
+            ++i;
+        }
+    }
+    return GL_TRUE;
+}
+
+GLint SkylinePacker::fit(GLuint index, GLuint width, GLuint height) const {
+    if (this->skyline[index].X + width > this->width)
+        return -1;
+    GLuint y = 0;
+    GLint remaining = width;
+    for (GLuint i = index; remaining > 0; ++i) {
+        if (i == this->skyline.size())
+            return -1;
+        y = std::max(y, this->skyline[i].Y);
+        if (y + height > this->height)
+            return -1;
+        remaining -= this->skyline[i].Width;
+    }
+    return y;
+}
+
+TextureAtlas::TextureAtlas(GLuint pageSize, GLuint padding)
+    : pageSize(pageSize), padding(padding) { }
+
+void TextureAtlas::Add(std::string name, GLuint width, GLuint height, const unsigned char* data) {
+    Image image;
+    image.Name = name;
+    image.Width = width;
+    image.Height = height;
+    image.Data.assign(data, data + width*height*4);
+    image.Page = image.X = image.Y = 0;
+    this->images.push_back(image);
+}
+
+std::map<std::string, Texture2D> TextureAtlas::Build() {
+    std::map<std::string, Texture2D> regions;
+
+    // tallest first keeps the skyline flat
+    std::vector<Image*> order;
+    for (Image &image : this->images)
+        order.push_back(&image);
+    std::sort(order.begin(), order.end(), [](const Image* a, const Image* b) {
+        return a->Height != b->Height ? a->Height > b->Height : a->Width > b->Width;
+    });
+
+    std::vector<SkylinePacker> packers;
+    for (Image* image : order) {
+        GLuint width = image->Width + 2*this->padding;
+        GLuint height = image->Height + 2*this->padding;
+        if (width > this->pageSize || height > this->pageSize) {
+            std::cout << "ERROR::ATLAS: Image does not fit in an atlas page: " << image->Name << std::endl;
+            image->Page = -1;
+            continue;
+        }
+
+        GLboolean packed = GL_FALSE;
+        for (GLuint page = 0; page < packers.size() && !packed; ++page) {
+            if (packers[page].Pack(width, height, image->X, image->Y)) {
+                image->Page = page;
+                packed = GL_TRUE;
+            }
+        }
+        if (!packed) {
+            packers.push_back(SkylinePacker(this->pageSize, this->pageSize));
+            packers.back().Pack(width, height, image->X, image->Y);
+            image->Page = packers.size() - 1;
+        }
+        image->X += this->padding;
+        image->Y += this->padding;
+    }
+
+    // mip levels past log2(padding) would sample across image borders
+    GLint maxLevel = 0;
+    while ((2u << maxLevel) <= this->padding)
+        ++maxLevel;
+
+    for (GLuint page = 0; page < packers.size(); ++page) {
+        std::vector<unsigned char> pixels(this->pageSize*this->pageSize*4, 0);
+        for (Image* image : order) {
+            if (image->Page == page)
+                this->blit(pixels, *image);
+        }
+
+        Texture2D texture;
+        texture.Internal_Format = GL_RGBA;
+        texture.Image_Format = GL_RGBA;
+        texture.Wrap_S = GL_CLAMP_TO_EDGE;
+        texture.Wrap_T = GL_CLAMP_TO_EDGE;
+        texture.Generate(this->pageSize, this->pageSize, &pixels[0]);
+        texture.Bind();
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+        GLState::BindTexture(0, 0);
+        this->Pages.push_back(texture);
+    }
+
+    GLfloat size = static_cast<GLfloat>(this->pageSize);
+    for (Image* image : order) {
+        if (image->Page >= this->Pages.size())
+            continue;
+        Texture2D region = this->Pages[image->Page];
+        region.Width = image->Width;
+        region.Height = image->Height;
+        region.Region = glm::vec4(image->X/size, image->Y/size, (image->X + image->Width)/size, (image->Y + image->Height)/size);
+        regions[image->Name] = region;
+    }
+
+    // pixel data lives on the GPU now
+    this->images.clear();
+    return regions;
+}
+
+void TextureAtlas::blit(std::vector<unsigned char> &page, const Image &image) const {
+    GLint pad = this->padding;
+    for (GLint y = -pad; y < (GLint)image.Height + pad; ++y) {
+        GLint srcY = std::min(std::max(y, 0), (GLint)image.Height - 1);
+        for (GLint x = -pad; x < (GLint)image.Width + pad; ++x) {
+            GLint srcX = std::min(std::max(x, 0), (GLint)image.Width - 1);
+            const unsigned char* src = &image.Data[(srcY*image.Width + srcX)*4];
+            unsigned char* dst = &page[((image.Y + y)*this->pageSize + image.X + x)*4];
+            std::copy(src, src + 4, dst);
+        }
+    }
+}
@@ -0,0 +1,74 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "texture.h"
+
+// Skyline bin packer, places rectangles on the lowest fitting segment of
+// the current skyline (bottom-left heuristic)
+class SkylinePacker {
+public:
+    // Constructor
+    SkylinePacker(GLuint width=0, GLuint height=0);
+
+    // Forget all packed rectangles
+    void Reset(GLuint width, GLuint height);
+    // Find a spot for a width x height rectangle, returns false if it does not fit
+    GLboolean Pack(GLuint width, GLuint height, GLuint &x, GLuint &y);
+
+private:
+    struct Segment {
+        GLuint X, Y, Width;
+    };
+    std::vector<Segment> skyline;
+    GLuint width, height;
+
+    // Returns the y coordinate a rectangle starting at segment index would rest at, or -1
+    GLint fit(GLuint index, GLuint width, GLuint height) const;
+};
+
+// Packs many small RGBA images into a few large texture pages. Each image
+// is surrounded by a border of its own edge pixels so mip levels up to
+// log2(padding) do not bleed into the neighbouring images.
+class TextureAtlas {
+public:
+    // Atlas textures, valid after Build
+    std::vector<Texture2D> Pages;
+
+    // Constructor
+    TextureAtlas(GLuint pageSize=2048, GLuint padding=8);
+
+    // Queue an RGBA image for packing, the pixels are copied
+    void Add(std::string name, GLuint width, GLuint height, const unsigned char* data);
+    // Pack all queued images, upload the pages and return a region per image
+    std::map<std::string, Texture2D> Build();
+
+private:
+    struct Image {
+        std::string Name;
+        GLuint Width, Height;
+        std::vector<unsigned char> Data;
+        GLuint Page, X, Y;
+    };
+    std::vector<Image> images;
+    GLuint pageSize;
+    GLuint padding;
+
+    // copy image into page with its edges extruded into the padding
+    void blit(std::vector<unsigned char> &page, const Image &image) const;
+};
+
+#endif
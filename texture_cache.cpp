@@ -0,0 +1,200 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "texture_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stb_image/stb_image.h>
+
+namespace {
+    GLenum formatOf(GLuint channels) {
+        if (channels == 1)
+            return GL_RED;
+        if (channels == 2)
+            return GL_RG;
+        if (channels == 3)
+            return GL_RGB;
+        return GL_RGBA;
+    }
+
+    // Cache entry of a source file, named by the hash of the path with empty
+    // and "." components dropped so different spellings share an entry.
+    // Images loaded with forced channels or without mipmaps get their own.
+    std::string cachePath(const std::string &file, GLint channels, GLboolean mipmaps) {
+        std::string normalized;
+        size_t start = 0;
+        while (start <= file.size()) {
+            size_t end = std::min(file.find('/', start), file.size());
+            std::string component = file.substr(start, end - start);
+            if (!component.empty() && component != ".")
+                normalized += (normalized.empty() ? "" : "/") + component;
+            start = end + 1;
+        }
+        GLchar name[17];
+        std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(HashBytes(reinterpret_cast<const unsigned char*>(normalized.data()), normalized.size())));
+        const GLchar* suffix = channels == 4 ? ".rgba" : channels == 3 ? ".rgb" : "";
+        return std::string(TEXTURE_CACHE_DIR) + "/" + name + suffix + (mipmaps ? "" : ".base") + ".btex";
+    }
+
+    // Map a whole file read only, empty if it can't be opened
+    std::shared_ptr<const void> mapFile(const std::string &path, size_t &size) {
+        GLint fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return std::shared_ptr<const void>();
+        struct stat info;
+        void* data = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(TextureFileHeader)))
+            data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+            return std::shared_ptr<const void>();
+        size = info.st_size;
+        return std::shared_ptr<const void>(data, [size](const void* mapping) { munmap(const_cast<void*>(mapping), size); });
+    }
+
+    // Check that header describes a complete entry built from the source with hash
+    GLboolean isValid(const TextureFileHeader &header, size_t size, GLuint64 hash, GLint channels) {
+        if (std::memcmp(header.Magic, TEXTURE_FILE_MAGIC, sizeof(header.Magic)) != 0 || header.Version != TEXTURE_FILE_VERSION
+            || header.SourceHash != hash || header.Channels == 0 || header.Channels > 4
+            || (channels != 0 && header.Channels != static_cast<GLuint>(channels))
+            || header.Levels == 0 || header.Levels > TEXTURE_MAX_LEVELS)
+            return GL_FALSE;
+        for (GLuint level = 0; level < header.Levels; ++level) {
+            unsigned long long expected = static_cast<unsigned long long>(std::max(header.Width >> level, 1u))*std::max(header.Height >> level, 1u)*header.Channels;
+            if (header.LevelSize[level] != expected || header.LevelOffset[level] % 4 != 0
+                || header.LevelOffset[level] + expected > size)
+                return GL_FALSE;
+        }
+        return GL_TRUE;
+    }
+
+    // Point texture at the levels of an entry starting at base
+    void describe(const unsigned char* base, CachedTexture &texture) {
+        const TextureFileHeader &header = *reinterpret_cast<const TextureFileHeader*>(base);
+        texture.Width = header.Width;
+        texture.Height = header.Height;
+        texture.Channels = header.Channels;
+        texture.Format = header.Format;
+        texture.Levels = header.Levels;
+        for (GLuint level = 0; level < header.Levels; ++level) {
+            texture.Data[level] = base + header.LevelOffset[level];
+            texture.Size[level] = header.LevelSize[level];
+        }
+    }
+
+    // Next level of the chain, every texel is the average of a 2x2 block
+    void downsample(const unsigned char* source, GLuint width, GLuint height, GLuint channels, unsigned char* target) {
+        GLuint targetWidth = std::max(width / 2, 1u), targetHeight = std::max(height / 2, 1u);
+        for (GLuint y = 0; y < targetHeight; ++y) {
+            GLuint y0 = std::min(2*y, height - 1), y1 = std::min(2*y + 1, height - 1);
+            for (GLuint x = 0; x < targetWidth; ++x) {
+                GLuint x0 = std::min(2*x, width - 1), x1 = std::min(2*x + 1, width - 1);
+                for (GLuint c = 0; c < channels; ++c) {
+                    GLuint sum = source[(y0*width + x0)*channels + c] + source[(y0*width + x1)*channels + c]
+                        + source[(y1*width + x0)*channels + c] + source[(y1*width + x1)*channels + c];
+                    target[(y*targetWidth + x)*channels + c] = (sum + 2) / 4;
+                }
+            }
+        }
+    }
+}
+
+GLuint64 HashBytes(const unsigned char* data, size_t size) {
+    GLuint64 hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+GLboolean LoadCachedTexture(const std::string &file, GLint channels, CachedTexture &texture, GLboolean mipmaps) {
+    texture.Levels = 0;
+    texture.FromCache = GL_FALSE;
+    std::ifstream fstream(file, std::ios::binary);
+    if (!fstream) {
+        std::cout << "ERROR::TEXTURE: Failed to read texture file: " << file << std::endl;
+        return GL_FALSE;
+    }
+    std::vector<unsigned char> source((std::istreambuf_iterator<char>(fstream)), std::istreambuf_iterator<char>());
+    GLuint64 hash = HashBytes(source.data(), source.size());
+    std::string path = cachePath(file, channels, mipmaps);
+
+    // use the entry if it was built from this exact source
+    size_t size = 0;
+    std::shared_ptr<const void> mapped = mapFile(path, size);
+    if (mapped && isValid(*static_cast<const TextureFileHeader*>(mapped.get()), size, hash, channels)) {
+        describe(static_cast<const unsigned char*>(mapped.get()), texture);
+        texture.Storage = mapped;
+        texture.FromCache = GL_TRUE;
+        return GL_TRUE;
+    }
+    mapped.reset();
+
+    GLint width, height, fileChannels;
+    unsigned char* image = stbi_load_from_memory(source.data(), source.size(), &width, &height, &fileChannels, channels);
+    if (!image) {
+        std::cout << "ERROR::TEXTURE: Failed to decode texture file: " << file << std::endl;
+        return GL_FALSE;
+    }
+    TextureFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.Magic, TEXTURE_FILE_MAGIC, sizeof(header.Magic));
+    header.Version = TEXTURE_FILE_VERSION;
+    header.SourceHash = hash;
+    header.Width = width;
+    header.Height = height;
+    header.Channels = channels != 0 ? channels : fileChannels;
+    header.Format = formatOf(header.Channels);
+    // every level down to 1x1, or just the first
+    GLuint offset = (sizeof(TextureFileHeader) + 3) & ~3u;
+    for (GLuint level = 0; level < TEXTURE_MAX_LEVELS; ++level) {
+        GLuint levelWidth = std::max(header.Width >> level, 1u), levelHeight = std::max(header.Height >> level, 1u);
+        header.LevelOffset[level] = offset;
+        header.LevelSize[level] = levelWidth*levelHeight*header.Channels;
+        offset = (offset + header.LevelSize[level] + 3) & ~3u;
+        header.Levels = level + 1;
+        if (!mipmaps || (levelWidth == 1 && levelHeight == 1))
+            break;
+    }
+
+    std::shared_ptr<std::vector<unsigned char>> entry = std::make_shared<std::vector<unsigned char>>(offset, 0);
+    unsigned char* base = entry->data();
+    std::memcpy(base, &header, sizeof(header));
+    std::memcpy(base + header.LevelOffset[0], image, header.LevelSize[0]);
+    stbi_image_free(image);
+    for (GLuint level = 1; level < header.Levels; ++level)
+        downsample(base + header.LevelOffset[level - 1], std::max(header.Width >> (level - 1), 1u), std::max(header.Height >> (level - 1), 1u),
+            header.Channels, base + header.LevelOffset[level]);
+    describe(base, texture);
+    texture.Storage = entry;
+
+    // write next to the entry and move it in place, a crash can't leave half an entry behind
+    mkdir(TEXTURE_CACHE_DIR, 0755);
+    std::string temporary = path + ".tmp";
+    std::ofstream cache(temporary, std::ios::binary | std::ios::trunc);
+    cache.write(reinterpret_cast<const GLchar*>(base), entry->size());
+    cache.close();
+    if (!cache || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cout << "ERROR::TEXTURE: Failed to write texture cache: " << path << std::endl;
+        std::remove(temporary.c_str());
+    }
+    return GL_TRUE;
+}
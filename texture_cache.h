@@ -0,0 +1,66 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <glad/glad.h>
+
+// Decoded images with their full mip chain are kept in TEXTURE_CACHE_DIR,
+// one .btex file per source image, named by the hash of its path. An entry
+// is used as long as the hash of the source file matches the one it was
+// built from, otherwise it is built again. The file is the header followed
+// by the levels, largest first, each tightly packed and starting on a 4
+// byte boundary.
+const GLchar TEXTURE_CACHE_DIR[] = "cache";
+const GLchar TEXTURE_FILE_MAGIC[4] = {'B', 'T', 'E', 'X'};
+const GLuint TEXTURE_FILE_VERSION = 1;
+const GLuint TEXTURE_MAX_LEVELS = 16;
+
+struct TextureFileHeader {
+    GLchar Magic[4];
+    GLuint Version;
+    // Hash of the source file the entry was built from
+    GLuint64 SourceHash;
+    GLuint Width, Height;
+    GLuint Channels;
+    // Pixel format of the levels, room for compressed formats later
+    GLuint Format;
+    GLuint Levels;
+    // Byte offsets from the start of the file and sizes of the levels
+    GLuint LevelOffset[TEXTURE_MAX_LEVELS];
+    GLuint LevelSize[TEXTURE_MAX_LEVELS];
+};
+
+// An image ready to be uploaded, level i is max(1, Width >> i) pixels wide
+struct CachedTexture {
+    GLuint Width, Height;
+    GLuint Channels;
+    GLenum Format;
+    GLuint Levels;
+    const unsigned char* Data[TEXTURE_MAX_LEVELS];
+    GLuint Size[TEXTURE_MAX_LEVELS];
+    // Keeps the mapped cache file or the freshly built levels alive
+    std::shared_ptr<const void> Storage;
+    // Whether the levels came from the cache instead of being decoded
+    GLboolean FromCache;
+};
+
+// FNV-1a hash of a block of bytes
+GLuint64 HashBytes(const unsigned char* data, size_t size);
+// Load an image with its mip chain from the cache, decoding it and writing
+// the entry when there is none or the source changed. channels = 0 keeps
+// the channels of the image, without mipmaps only the full size level is
+// built and stored. Makes no OpenGL calls, so it can run on any thread as
+// long as no two threads load the same file at once.
+GLboolean LoadCachedTexture(const std::string &file, GLint channels, CachedTexture &texture, GLboolean mipmaps=GL_TRUE);
+
+#endif